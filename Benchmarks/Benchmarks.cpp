@@ -0,0 +1,1149 @@
+#include "../Delegates.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <array>
+#include <string>
+#include <thread>
+#include <functional>
+#include <future>
+
+//Benchmarks for the delegates
+//Building on Linux requires no dependencies:
+//g++ -O2 -std=c++14 -pthread Benchmarks/Benchmarks.cpp Delegates.cpp -o DelegateBenchmarks
+//
+//Usage: DelegateBenchmarks [--format=text|csv|json] [--filter=<substring>] [--min-time=<ms>]
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define BENCHMARK_NOINLINE __attribute__((noinline))
+#endif
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	enum class OutputFormat
+	{
+		Text,
+		Csv,
+		Json,
+	};
+
+	struct Result
+	{
+		std::string Group;
+		std::string Name;
+		int Threads;
+		size_t Iterations;
+		double NanosecondsPerOperation;
+	};
+
+	struct Settings
+	{
+		OutputFormat Format = OutputFormat::Text;
+		std::string Filter;
+		double MinSeconds = 0.1;
+	};
+
+	Settings g_Settings;
+	std::vector<Result> g_Results;
+
+	volatile int g_Sink = 0;
+#if defined(_MSC_VER)
+	volatile void* g_pEscape = nullptr;
+#endif
+
+	//Makes the compiler assume the object is read and modified so bound targets can't be devirtualized
+	template<typename T>
+	inline void Escape(T& value)
+	{
+#if defined(_MSC_VER)
+		g_pEscape = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r"(&value) : "memory");
+#endif
+	}
+
+	bool IsEnabled(const char* pGroup, const char* pName)
+	{
+		if (g_Settings.Filter.empty())
+		{
+			return true;
+		}
+		std::string fullName = std::string(pGroup) + "/" + pName;
+		return fullName.find(g_Settings.Filter) != std::string::npos;
+	}
+
+	void Report(const char* pGroup, const char* pName, int threadCount, size_t iterations, double seconds)
+	{
+		Result result;
+		result.Group = pGroup;
+		result.Name = pName;
+		result.Threads = threadCount;
+		result.Iterations = iterations;
+		result.NanosecondsPerOperation = seconds * 1e9 / (double)iterations;
+		if (g_Settings.Format == OutputFormat::Text)
+		{
+			printf("%-20s %-40s threads: %-3d %10.2f ns/op %12.2f Mops/s\n",
+				pGroup, pName, threadCount, result.NanosecondsPerOperation, threadCount * 1000.0 / result.NanosecondsPerOperation);
+			fflush(stdout);
+		}
+		g_Results.push_back(result);
+	}
+
+	//Runs the benchmark with a doubling amount of iterations until it takes at least the minimum time
+	//Setup creates the state the benchmark works on before every run, like a multicast with its listeners.
+	//Only the benchmark is timed, it receives the state and the amount of operations to do.
+	template<typename Setup, typename Benchmark>
+	void Run(const char* pGroup, const char* pName, Setup&& setup, Benchmark&& benchmark)
+	{
+		if (!IsEnabled(pGroup, pName))
+		{
+			return;
+		}
+		size_t iterations = 1 << 10;
+		for (;;)
+		{
+			auto state = setup();
+			Clock::time_point begin = Clock::now();
+			benchmark(state, iterations);
+			double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+			if (seconds >= g_Settings.MinSeconds || iterations >= ((size_t)1 << 32))
+			{
+				Report(pGroup, pName, 1, iterations, seconds);
+				return;
+			}
+			iterations *= 2;
+		}
+	}
+
+	//Runs a benchmark without any state, it receives the amount of operations to do
+	template<typename Benchmark>
+	void Run(const char* pGroup, const char* pName, Benchmark&& benchmark)
+	{
+		Run(pGroup, pName, []() { return 0; }, [&benchmark](int, size_t count) { benchmark(count); });
+	}
+
+	//Runs the benchmark on the given amount of threads at once
+	//Every thread does the given amount of operations
+	template<typename Benchmark>
+	void RunThreaded(const char* pGroup, const char* pName, int threadCount, size_t iterations, Benchmark&& benchmark)
+	{
+		if (!IsEnabled(pGroup, pName))
+		{
+			return;
+		}
+		std::atomic<int> ready(0);
+		std::atomic<bool> start(false);
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (int i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back([&]()
+				{
+					++ready;
+					while (!start)
+					{
+						std::this_thread::yield();
+					}
+					benchmark(iterations);
+				});
+		}
+		while (ready != threadCount)
+		{
+			std::this_thread::yield();
+		}
+		Clock::time_point begin = Clock::now();
+		start = true;
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+		//Report the time per operation as seen from a single thread
+		Report(pGroup, pName, threadCount, iterations * threadCount, seconds * threadCount);
+	}
+
+	void WriteCsv()
+	{
+		printf("group,name,threads,iterations,ns_per_op,mops_per_s\n");
+		for (const Result& result : g_Results)
+		{
+			printf("%s,%s,%d,%zu,%.4f,%.4f\n", result.Group.c_str(), result.Name.c_str(), result.Threads, result.Iterations,
+				result.NanosecondsPerOperation, result.Threads * 1000.0 / result.NanosecondsPerOperation);
+		}
+	}
+
+	void WriteJson()
+	{
+		printf("{\n\t\"benchmarks\": [\n");
+		for (size_t i = 0; i < g_Results.size(); ++i)
+		{
+			const Result& result = g_Results[i];
+			printf("\t\t{ \"group\": \"%s\", \"name\": \"%s\", \"threads\": %d, \"iterations\": %zu, \"ns_per_op\": %.4f, \"mops_per_s\": %.4f }%s\n",
+				result.Group.c_str(), result.Name.c_str(), result.Threads, result.Iterations,
+				result.NanosecondsPerOperation, result.Threads * 1000.0 / result.NanosecondsPerOperation,
+				i + 1 < g_Results.size() ? "," : "");
+		}
+		printf("\t]\n}\n");
+	}
+
+	bool ParseArguments(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* pArg = argv[i];
+			if (strcmp(pArg, "--format=text") == 0)
+			{
+				g_Settings.Format = OutputFormat::Text;
+			}
+			else if (strcmp(pArg, "--format=csv") == 0)
+			{
+				g_Settings.Format = OutputFormat::Csv;
+			}
+			else if (strcmp(pArg, "--format=json") == 0)
+			{
+				g_Settings.Format = OutputFormat::Json;
+			}
+			else if (strncmp(pArg, "--filter=", 9) == 0)
+			{
+				g_Settings.Filter = pArg + 9;
+			}
+			else if (strncmp(pArg, "--min-time=", 11) == 0)
+			{
+				g_Settings.MinSeconds = atof(pArg + 11) / 1000.0;
+			}
+			else
+			{
+				fprintf(stderr, "Usage: %s [--format=text|csv|json] [--filter=<substring>] [--min-time=<ms>]\n", argv[0]);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	///////////////////////////////////////////////////////////////
+	//////////////////// TARGETS //////////////////////////////////
+	///////////////////////////////////////////////////////////////
+
+	BENCHMARK_NOINLINE int StaticFunction(int a)
+	{
+		return a + 1;
+	}
+
+	void Dummy(int)
+	{
+	}
+
+	BENCHMARK_NOINLINE void StaticNotify(int a)
+	{
+		g_Sink = a;
+	}
+
+	//Same as StaticNotify but can be inlined
+	void InlineNotify(int a)
+	{
+		g_Sink = a;
+	}
+
+	struct Foo
+	{
+		BENCHMARK_NOINLINE int Bar(int a)
+		{
+			return a + Value;
+		}
+		BENCHMARK_NOINLINE void Notify(int a)
+		{
+			Value += a;
+		}
+		int Value = 1;
+	};
+
+	///////////////////////////////////////////////////////////////
+	//////////////////// EXECUTE //////////////////////////////////
+	///////////////////////////////////////////////////////////////
+
+	template<typename Callable>
+	void ExecuteLoop(Callable& callable, size_t count)
+	{
+		int sum = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Escape(callable);
+			sum += callable((int)i);
+		}
+		g_Sink = sum;
+	}
+
+	template<typename DelegateT>
+	void ExecuteDelegateLoop(DelegateT& del, size_t count)
+	{
+		int sum = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Escape(del);
+			sum += del.Execute((int)i);
+		}
+		g_Sink = sum;
+	}
+
+	void BenchmarkExecute()
+	{
+		Foo foo;
+		std::shared_ptr<Foo> pFoo = std::make_shared<Foo>();
+		std::array<char, 128> data{};
+
+		Run("Execute", "Raw function pointer", [](size_t count)
+			{
+				int(*pFunction)(int) = &StaticFunction;
+				ExecuteLoop(pFunction, count);
+			});
+		Run("Execute", "Raw member function pointer", [&foo](size_t count)
+			{
+				int(Foo::*pFunction)(int) = &Foo::Bar;
+				auto call = [&foo, pFunction](int a) { return (foo.*pFunction)(a); };
+				ExecuteLoop(call, count);
+			});
+		Run("Execute", "std::function static", [](size_t count)
+			{
+				std::function<int(int)> function = &StaticFunction;
+				ExecuteLoop(function, count);
+			});
+		Run("Execute", "std::function member", [&foo](size_t count)
+			{
+				std::function<int(int)> function = std::bind(&Foo::Bar, &foo, std::placeholders::_1);
+				ExecuteLoop(function, count);
+			});
+		Run("Execute", "std::function lambda", [](size_t count)
+			{
+				std::function<int(int)> function = [](int a) { return a + 1; };
+				ExecuteLoop(function, count);
+			});
+		Run("Execute", "std::function large lambda", [&data](size_t count)
+			{
+				std::function<int(int)> function = [data](int a) { return a + data[0]; };
+				ExecuteLoop(function, count);
+			});
+		Run("Execute", "Delegate static", [](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateStatic(&StaticFunction);
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate raw", [&foo](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateRaw(&foo, &Foo::Bar);
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate direct static", [](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::Create<decltype(&StaticFunction), &StaticFunction>();
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate direct raw", [&foo](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::Create<decltype(&Foo::Bar), &Foo::Bar>(&foo);
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "CompactDelegate raw", [&foo](size_t count)
+			{
+				CompactDelegate<int, int> del = CompactDelegate<int, int>::CreateRaw(&foo, &Foo::Bar);
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "CompactDelegate direct raw", [&foo](size_t count)
+			{
+				CompactDelegate<int, int> del = CompactDelegate<int, int>::Create<decltype(&Foo::Bar), &Foo::Bar>(&foo);
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate lambda", [](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a) { return a + 1; });
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate large lambda", [&data](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([data](int a) { return a + data[0]; });
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate shared_ptr", [&pFoo](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateSP(pFoo, &Foo::Bar);
+				ExecuteDelegateLoop(del, count);
+			});
+		Run("Execute", "Delegate payload", [](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a, int b) { return a + b; }, 1);
+				ExecuteDelegateLoop(del, count);
+			});
+	}
+
+	///////////////////////////////////////////////////////////////
+	//////////////////// BROADCAST ////////////////////////////////
+	///////////////////////////////////////////////////////////////
+
+	void BenchmarkBroadcast()
+	{
+		const int listenerCounts[] = { 1, 8, 64, 1024 };
+		for (int listenerCount : listenerCounts)
+		{
+			std::vector<Foo> foos(listenerCount);
+
+			std::string name = "MulticastDelegate " + std::to_string(listenerCount);
+			Run("Broadcast", name.c_str(), [&foos]()
+				{
+					MulticastDelegate<int> multicast;
+					for (Foo& foo : foos)
+					{
+						multicast.AddRaw(&foo, &Foo::Notify);
+					}
+					return multicast;
+				},
+				[](MulticastDelegate<int>& multicast, size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						Escape(multicast);
+						multicast.Broadcast((int)i);
+					}
+				});
+
+			name = "std::vector<std::function> " + std::to_string(listenerCount);
+			Run("Broadcast", name.c_str(), [&foos]()
+				{
+					std::vector<std::function<void(int)>> functions;
+					for (Foo& foo : foos)
+					{
+						functions.push_back(std::bind(&Foo::Notify, &foo, std::placeholders::_1));
+					}
+					return functions;
+				},
+				[](std::vector<std::function<void(int)>>& functions, size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						Escape(functions);
+						for (std::function<void(int)>& function : functions)
+						{
+							function((int)i);
+						}
+					}
+				});
+
+			name = "std::vector<function pointer> " + std::to_string(listenerCount);
+			Run("Broadcast", name.c_str(), [listenerCount]()
+				{
+					return std::vector<void(*)(int)>(listenerCount, &StaticNotify);
+				},
+				[](std::vector<void(*)(int)>& functions, size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						Escape(functions);
+						for (void(*pFunction)(int) : functions)
+						{
+							pFunction((int)i);
+						}
+					}
+				});
+		}
+	}
+
+	//Listeners known at compile time compared to the same function pointers in an array
+	void BenchmarkStaticBroadcast()
+	{
+		Run("Broadcast", "StaticMulticastDelegate 8", [](size_t count)
+			{
+				using Multicast = StaticMulticastDelegate<void(*)(int), &StaticNotify, &StaticNotify, &StaticNotify, &StaticNotify, &StaticNotify, &StaticNotify, &StaticNotify, &StaticNotify>;
+				for (size_t i = 0; i < count; ++i)
+				{
+					Multicast::Broadcast((int)i);
+				}
+			});
+
+		Run("Broadcast", "StaticMulticastDelegate 8 inlined", [](size_t count)
+			{
+				using Multicast = StaticMulticastDelegate<void(*)(int), &InlineNotify, &InlineNotify, &InlineNotify, &InlineNotify, &InlineNotify, &InlineNotify, &InlineNotify, &InlineNotify>;
+				for (size_t i = 0; i < count; ++i)
+				{
+					Multicast::Broadcast((int)i);
+				}
+			});
+	}
+
+	//An event on every entity where only a few have listeners, one op is a Broadcast on all of them
+	template<typename MulticastT>
+	void RunSparseBroadcast(const char* pName)
+	{
+		const size_t entityCount = 4096;
+		Foo foo;
+		Run("Broadcast", pName, [&foo, entityCount]()
+			{
+				std::vector<MulticastT> multicasts(entityCount);
+				for (size_t i = 0; i < entityCount; i += 64)
+				{
+					multicasts[i].AddRaw(&foo, &Foo::Notify);
+				}
+				return multicasts;
+			},
+			[](std::vector<MulticastT>& multicasts, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					Escape(multicasts);
+					for (MulticastT& multicast : multicasts)
+					{
+						multicast.Broadcast((int)i);
+					}
+				}
+			});
+	}
+
+	void BenchmarkSparseBroadcast()
+	{
+		RunSparseBroadcast<MulticastDelegate<int>>("MulticastDelegate sparse 4096");
+		RunSparseBroadcast<CompactMulticastDelegate<int>>("CompactMulticastDelegate sparse 4096");
+	}
+
+	//An event argument that isn't cheap to copy
+	struct LargeEvent
+	{
+		std::string Name = "A name that doesn't fit in the small string buffer";
+		std::vector<int> Values = std::vector<int>(16, 1);
+	};
+
+	void BenchmarkLargeArgument()
+	{
+		Run("Broadcast", "MulticastDelegate large argument 8", []()
+			{
+				MulticastDelegate<LargeEvent> multicast;
+				for (int i = 0; i < 8; ++i)
+				{
+					multicast.AddLambda([](LargeEvent event) { g_Sink += event.Values[0]; });
+				}
+				return multicast;
+			},
+			[](MulticastDelegate<LargeEvent>& multicast, size_t count)
+			{
+				LargeEvent event;
+				for (size_t i = 0; i < count; ++i)
+				{
+					Escape(multicast);
+					multicast.Broadcast(event);
+				}
+			});
+
+		Run("Broadcast", "MulticastDelegate const reference argument 8", []()
+			{
+				MulticastDelegate<const LargeEvent&> multicast;
+				for (int i = 0; i < 8; ++i)
+				{
+					multicast.AddLambda([](const LargeEvent& event) { g_Sink += event.Values[0]; });
+				}
+				return multicast;
+			},
+			[](MulticastDelegate<const LargeEvent&>& multicast, size_t count)
+			{
+				LargeEvent event;
+				for (size_t i = 0; i < count; ++i)
+				{
+					Escape(multicast);
+					multicast.Broadcast(event);
+				}
+			});
+	}
+
+	//Many events for every listener, one Broadcast per event compared to a single BroadcastBatch
+	void BenchmarkBroadcastBatch()
+	{
+		const int listenerCount = 64;
+		const int eventCount = 1024;
+		std::vector<Foo> foos(listenerCount);
+		std::vector<MulticastDelegate<int>::ArgumentTuple> events;
+		for (int i = 0; i < eventCount; ++i)
+		{
+			events.emplace_back(i);
+		}
+		auto addListeners = [&foos]()
+		{
+			MulticastDelegate<int> multicast;
+			for (Foo& foo : foos)
+			{
+				multicast.AddRaw(&foo, &Foo::Notify);
+			}
+			return multicast;
+		};
+
+		Run("BroadcastBatch", "Broadcast 64x1024", addListeners, [&](MulticastDelegate<int>& multicast, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					for (int j = 0; j < eventCount; ++j)
+					{
+						Escape(multicast);
+						multicast.Broadcast(j);
+					}
+				}
+			});
+
+		Run("BroadcastBatch", "BroadcastBatch 64x1024", addListeners, [&](MulticastDelegate<int>& multicast, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					Escape(multicast);
+					multicast.BroadcastBatch(events);
+				}
+			});
+
+		Run("BroadcastBatch", "BroadcastBatch batch delegates 64x1024", [&foos]()
+			{
+				MulticastDelegate<int> multicast;
+				for (Foo& foo : foos)
+				{
+					multicast.AddBatchLambda([&foo](MulticastDelegate<int>::BatchT batch)
+						{
+							for (const MulticastDelegate<int>::ArgumentTuple& arguments : batch)
+							{
+								foo.Value += std::get<0>(arguments);
+							}
+						});
+				}
+				return multicast;
+			},
+			[&](MulticastDelegate<int>& multicast, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					Escape(multicast);
+					multicast.BroadcastBatch(events);
+				}
+			});
+	}
+
+	//Hundreds of listeners that do some work each
+	void BenchmarkBroadcastParallel()
+	{
+		const int listenerCount = 256;
+		std::vector<Foo> foos(listenerCount);
+		auto addListeners = [&foos]()
+		{
+			MulticastDelegate<int> multicast;
+			for (Foo& foo : foos)
+			{
+				multicast.AddLambda([&foo](int a)
+					{
+						for (int i = 0; i < 1000; ++i)
+						{
+							foo.Value = foo.Value * 31 + a;
+						}
+					});
+			}
+			return multicast;
+		};
+
+		Run("BroadcastParallel", "Broadcast 256 heavy", addListeners, [](MulticastDelegate<int>& multicast, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					multicast.Broadcast((int)i);
+				}
+			});
+
+		std::string name = "BroadcastParallel 256 heavy (" + std::to_string(Delegates::WorkStealingExecutor::GetDefault().GetThreadCount()) + " workers)";
+		Run("BroadcastParallel", name.c_str(), addListeners, [](MulticastDelegate<int>& multicast, size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					multicast.BroadcastParallel((int)i);
+				}
+			});
+	}
+
+	//Overhead of an asynchronous call, the executor runs the task right away
+	void BenchmarkAsync()
+	{
+		struct InlineExecutor : public Delegates::IExecutor
+		{
+			virtual void ParallelFor(size_t count, TaskFunction pFunction, void* pContext) override
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					pFunction(pContext, i);
+				}
+			}
+		};
+
+		Run("Async", "Delegate::ExecuteOn", [](size_t count)
+			{
+				InlineExecutor executor;
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a) { return a + 1; });
+				int sum = 0;
+				for (size_t i = 0; i < count; ++i)
+				{
+					sum += del.ExecuteOn(executor, (int)i).Get();
+				}
+				g_Sink = sum;
+			});
+
+		Run("Async", "std::packaged_task", [](size_t count)
+			{
+				std::function<int(int)> function = [](int a) { return a + 1; };
+				int sum = 0;
+				for (size_t i = 0; i < count; ++i)
+				{
+					std::packaged_task<int(int)> task(function);
+					std::future<int> future = task.get_future();
+					task((int)i);
+					sum += future.get();
+				}
+				g_Sink = sum;
+			});
+	}
+
+	//Deferred broadcasts of 256 events with a string argument
+	void BenchmarkEventQueue()
+	{
+		const std::string text = "Deferred event";
+
+		Run("EventQueue", "EventQueue::Enqueue+Flush", [&text](size_t count)
+			{
+				EventQueue queue;
+				MulticastDelegate<int, const std::string&> multicast;
+				size_t sum = 0;
+				multicast.AddLambda([&sum](int a, const std::string& value) { sum += a + value.size(); });
+				for (size_t i = 0; i < count; i += 256)
+				{
+					for (int j = 0; j < 256; ++j)
+					{
+						queue.Enqueue(multicast, j, text);
+					}
+					queue.Flush();
+				}
+				g_Sink = (int)sum;
+			});
+
+		Run("EventQueue", "std::vector<std::function>", [&text](size_t count)
+			{
+				std::vector<std::function<void()>> queue;
+				MulticastDelegate<int, const std::string&> multicast;
+				size_t sum = 0;
+				multicast.AddLambda([&sum](int a, const std::string& value) { sum += a + value.size(); });
+				for (size_t i = 0; i < count; i += 256)
+				{
+					for (int j = 0; j < 256; ++j)
+					{
+						std::string value = text;
+						queue.push_back([&multicast, j, value]() { multicast.Broadcast(j, value); });
+					}
+					for (const std::function<void()>& event : queue)
+					{
+						event();
+					}
+					queue.clear();
+				}
+				g_Sink = (int)sum;
+			});
+	}
+
+	//Posting 256 small closures to the owner thread and running them
+	void BenchmarkDispatcher()
+	{
+		Run("Dispatcher", "DelegateDispatcher::Post+Dispatch", [](size_t count)
+			{
+				DelegateDispatcher dispatcher;
+				int sum = 0;
+				Delegate<void, int> del = Delegate<void, int>::CreateLambda([&sum](int a) { sum += a; });
+				for (size_t i = 0; i < count; i += 256)
+				{
+					for (int j = 0; j < 256; ++j)
+					{
+						dispatcher.Post(del, j);
+					}
+					dispatcher.Dispatch();
+				}
+				g_Sink = sum;
+			});
+
+		Run("Dispatcher", "std::mutex+std::vector<std::function>", [](size_t count)
+			{
+				std::mutex lock;
+				std::vector<std::function<void()>> queue;
+				std::vector<std::function<void()>> dispatching;
+				int sum = 0;
+				for (size_t i = 0; i < count; i += 256)
+				{
+					for (int j = 0; j < 256; ++j)
+					{
+						std::lock_guard<std::mutex> guard(lock);
+						queue.push_back([&sum, j]() { sum += j; });
+					}
+					{
+						std::lock_guard<std::mutex> guard(lock);
+						dispatching.swap(queue);
+					}
+					for (const std::function<void()>& function : dispatching)
+					{
+						function();
+					}
+					dispatching.clear();
+				}
+				g_Sink = sum;
+			});
+	}
+
+	//32 listeners contributing a score that is summed
+	void BenchmarkAggregate()
+	{
+		Run("Aggregate", "MulticastDelegateRet Sum 32", []()
+			{
+				MulticastDelegateRet<float, float> multicast;
+				for (int i = 0; i < 32; ++i)
+				{
+					multicast.AddLambda([i](float a) { return a * (float)i; });
+				}
+				return multicast;
+			},
+			[](MulticastDelegateRet<float, float>& multicast, size_t count)
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; i += 32)
+				{
+					sum += multicast.Broadcast<Delegates::Sum<float>>(1.0f);
+				}
+				g_Sink = (int)sum;
+			});
+
+		Run("Aggregate", "std::vector<std::function> Sum 32", []()
+			{
+				std::vector<std::function<float(float)>> functions;
+				for (int i = 0; i < 32; ++i)
+				{
+					functions.push_back([i](float a) { return a * (float)i; });
+				}
+				return functions;
+			},
+			[](std::vector<std::function<float(float)>>& functions, size_t count)
+			{
+				float sum = 0.0f;
+				for (size_t i = 0; i < count; i += 32)
+				{
+					for (const std::function<float(float)>& function : functions)
+					{
+						sum += function(1.0f);
+					}
+				}
+				g_Sink = (int)sum;
+			});
+	}
+
+	///////////////////////////////////////////////////////////////
+	//////////////////// CHURN ////////////////////////////////////
+	///////////////////////////////////////////////////////////////
+
+	void BenchmarkChurn()
+	{
+		const int listenerCounts[] = { 0, 64, 1024 };
+		for (int listenerCount : listenerCounts)
+		{
+			std::string name = "MulticastDelegate Add/Remove " + std::to_string(listenerCount);
+			Run("Churn", name.c_str(), [listenerCount]()
+				{
+					MulticastDelegate<int> multicast;
+					for (int i = 0; i < listenerCount; ++i)
+					{
+						multicast.AddStatic(&Dummy);
+					}
+					return multicast;
+				},
+				[](MulticastDelegate<int>& multicast, size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						DelegateHandle handle = multicast.AddStatic(&Dummy);
+						multicast.Remove(handle);
+					}
+				});
+
+			//Priorities keep the order so the listeners behind the removed one are shifted
+			name = "MulticastDelegate Add/Remove with priority " + std::to_string(listenerCount);
+			Run("Churn", name.c_str(), [listenerCount]()
+				{
+					MulticastDelegate<int> multicast;
+					for (int i = 0; i < listenerCount; ++i)
+					{
+						multicast.Add(MulticastDelegate<int>::DelegateT::CreateStatic(&Dummy), i % 8);
+					}
+					return multicast;
+				},
+				[](MulticastDelegate<int>& multicast, size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						DelegateHandle handle = multicast.Add(MulticastDelegate<int>::DelegateT::CreateStatic(&Dummy), 4);
+						multicast.Remove(handle);
+					}
+				});
+
+			//Removing a std::function requires a linear search on some identifier
+			name = "std::vector<std::function> Add/Remove " + std::to_string(listenerCount);
+			using FunctionList = std::vector<std::pair<size_t, std::function<void(int)>>>;
+			Run("Churn", name.c_str(), [listenerCount]()
+				{
+					FunctionList functions;
+					for (int i = 0; i < listenerCount; ++i)
+					{
+						functions.emplace_back((size_t)i, &Dummy);
+					}
+					return functions;
+				},
+				[listenerCount](FunctionList& functions, size_t count)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						size_t id = listenerCount + i;
+						functions.emplace_back(id, &Dummy);
+						for (auto it = functions.begin(); it != functions.end(); ++it)
+						{
+							if (it->first == id)
+							{
+								*it = std::move(functions.back());
+								functions.pop_back();
+								break;
+							}
+						}
+					}
+				});
+		}
+	}
+
+	///////////////////////////////////////////////////////////////
+	//////////////////// COPY/MOVE ////////////////////////////////
+	///////////////////////////////////////////////////////////////
+
+	template<typename T>
+	void CopyLoop(const T& source, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			T copy = source;
+			Escape(copy);
+		}
+	}
+
+	template<typename T>
+	void MoveLoop(T& source, size_t count)
+	{
+		T other;
+		for (size_t i = 0; i < count; ++i)
+		{
+			other = std::move(source);
+			Escape(other);
+			source = std::move(other);
+			Escape(source);
+		}
+	}
+
+	void BenchmarkCopyMove()
+	{
+		std::array<char, 128> data{};
+		Foo foo;
+		auto addListeners = [&foo]()
+		{
+			MulticastDelegate<int> multicast;
+			for (int i = 0; i < 8; ++i)
+			{
+				multicast.AddRaw(&foo, &Foo::Notify);
+			}
+			return multicast;
+		};
+
+		Run("Copy", "std::function lambda", [](size_t count)
+			{
+				std::function<int(int)> function = [](int a) { return a + 1; };
+				CopyLoop(function, count);
+			});
+		Run("Copy", "std::function large lambda", [&data](size_t count)
+			{
+				std::function<int(int)> function = [data](int a) { return a + data[0]; };
+				CopyLoop(function, count);
+			});
+		Run("Copy", "Delegate lambda", [](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a) { return a + 1; });
+				CopyLoop(del, count);
+			});
+		Run("Copy", "Delegate large lambda", [&data](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([data](int a) { return a + data[0]; });
+				CopyLoop(del, count);
+			});
+		Run("Copy", "Delegate shared large lambda", [&data](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([data](int a) { return a + data[0]; });
+				del.Share();
+				CopyLoop(del, count);
+			});
+		Run("Copy", "MulticastDelegate 8", addListeners, [](MulticastDelegate<int>& multicast, size_t count)
+			{
+				CopyLoop(multicast, count);
+			});
+
+		//Every iteration does two moves
+		Run("Move", "std::function lambda", [](size_t count)
+			{
+				std::function<int(int)> function = [](int a) { return a + 1; };
+				MoveLoop(function, count / 2);
+			});
+		Run("Move", "std::function large lambda", [&data](size_t count)
+			{
+				std::function<int(int)> function = [data](int a) { return a + data[0]; };
+				MoveLoop(function, count / 2);
+			});
+		Run("Move", "Delegate lambda", [](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a) { return a + 1; });
+				MoveLoop(del, count / 2);
+			});
+		Run("Move", "Delegate large lambda", [&data](size_t count)
+			{
+				Delegate<int, int> del = Delegate<int, int>::CreateLambda([data](int a) { return a + data[0]; });
+				MoveLoop(del, count / 2);
+			});
+		Run("Move", "Delegate shared_ptr", [](size_t count)
+			{
+				std::shared_ptr<Foo> pFoo = std::make_shared<Foo>();
+				Delegate<int, int> del = Delegate<int, int>::CreateSP(pFoo, &Foo::Bar);
+				MoveLoop(del, count / 2);
+			});
+		Run("Move", "MulticastDelegate 8", addListeners, [](MulticastDelegate<int>& multicast, size_t count)
+			{
+				MoveLoop(multicast, count / 2);
+			});
+	}
+
+	///////////////////////////////////////////////////////////////
+	//////////////////// THREADING / ALLOCATION ///////////////////
+	///////////////////////////////////////////////////////////////
+
+	//Keeps a working set of live allocations of mixed sizes and replaces one every iteration
+	template<typename AllocFunction, typename FreeFunction>
+	void AllocationChurn(size_t count, AllocFunction&& allocate, FreeFunction&& release)
+	{
+		const size_t sizes[] = { 48, 96, 200, 400, 1000 };
+		void* allocations[64] = {};
+		for (size_t i = 0; i < count; ++i)
+		{
+			void*& pPtr = allocations[i % 64];
+			release(pPtr);
+			pPtr = allocate(sizes[i % 5]);
+		}
+		for (void* pPtr : allocations)
+		{
+			release(pPtr);
+		}
+	}
+
+	//Bind a lambda that doesn't fit inline every iteration
+	void BindLarge(size_t count)
+	{
+		std::array<char, 256> data{};
+		Delegate<int> del;
+		int sum = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			data[0] = (char)i;
+			del.BindLambda([data]() { return (int)data[0]; });
+			sum += del.Execute();
+		}
+		g_Sink = sum;
+	}
+
+	void BenchmarkThreading()
+	{
+		const size_t iterations = 1 << 20;
+		const int threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+
+		for (int threadCount : threadCounts)
+		{
+			RunThreaded("Threaded", "DelegateHandle", threadCount, iterations, [](size_t count)
+				{
+					unsigned int sum = 0;
+					for (size_t i = 0; i < count; ++i)
+					{
+						DelegateHandle handle(true);
+						sum += handle.IsValid();
+					}
+					g_Sink = (int)sum;
+				});
+		}
+
+		for (int threadCount : threadCounts)
+		{
+			RunThreaded("Threaded", "MulticastDelegate Add/Remove", threadCount, iterations, [](size_t count)
+				{
+					MulticastDelegate<int> multicast;
+					for (size_t i = 0; i < count; ++i)
+					{
+						DelegateHandle handle = multicast.AddStatic(&Dummy);
+						multicast.Remove(handle);
+					}
+				});
+		}
+
+		for (int threadCount : threadCounts)
+		{
+			RunThreaded("Allocation", "Alloc/Free malloc", threadCount, iterations, [](size_t count)
+				{
+					AllocationChurn(count, [](size_t size) { return malloc(size); }, [](void* pPtr) { free(pPtr); });
+				});
+			RunThreaded("Allocation", "Alloc/Free SlabAllocator", threadCount, iterations, [](size_t count)
+				{
+					AllocationChurn(count, &Delegates::SlabAllocator::Allocate, &Delegates::SlabAllocator::Free);
+				});
+		}
+
+		Run("Allocation", "Bind large lambda malloc", &BindLarge);
+		Delegates::SlabAllocator::Install();
+		Run("Allocation", "Bind large lambda SlabAllocator", &BindLarge);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (!ParseArguments(argc, argv))
+	{
+		return 1;
+	}
+
+	BenchmarkExecute();
+	BenchmarkBroadcast();
+	BenchmarkStaticBroadcast();
+	BenchmarkSparseBroadcast();
+	BenchmarkLargeArgument();
+	BenchmarkBroadcastBatch();
+	BenchmarkBroadcastParallel();
+	BenchmarkAsync();
+	BenchmarkEventQueue();
+	BenchmarkDispatcher();
+	BenchmarkAggregate();
+	BenchmarkChurn();
+	BenchmarkCopyMove();
+	BenchmarkThreading();
+
+	switch (g_Settings.Format)
+	{
+	case OutputFormat::Csv:
+		WriteCsv();
+		break;
+	case OutputFormat::Json:
+		WriteJson();
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
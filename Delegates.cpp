@@ -1,3 +1,706 @@
 #include "Delegates.h"
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
+#include <functional>
 
-unsigned int DelegateHandle::CURRENT_ID = 0;
\ No newline at end of file
+std::atomic<unsigned int> DelegateHandle::CURRENT_ID(0);
+constexpr const unsigned int DelegateHandle::INVALID_ID;
+
+namespace
+{
+	//Every block is preceded by a header that stores its size class
+	//16 bytes to keep the returned memory 16 byte aligned
+	constexpr size_t HeaderSize = 16;
+	constexpr size_t ChunkSize = 64 * 1024;
+	//Amount of blocks a thread cache takes from or returns to the global pool at once
+	constexpr size_t BatchSize = 32;
+
+	constexpr size_t GetNumSizeClasses()
+	{
+		size_t count = 1;
+		for (size_t size = Delegates::SlabAllocator::MinBlockSize; size < Delegates::SlabAllocator::MaxBlockSize; size <<= 1)
+		{
+			++count;
+		}
+		return count;
+	}
+	constexpr size_t NumSizeClasses = GetNumSizeClasses();
+	//Size class stored in the header of allocations that went to malloc
+	constexpr size_t LargeSizeClass = NumSizeClasses;
+
+	struct Block
+	{
+		Block* pNext;
+	};
+
+	struct SizeClassPool
+	{
+		std::mutex Lock;
+		Block* pFree = nullptr;
+	};
+
+	//Never destroyed, delegates can still be freed during static destruction
+	SizeClassPool* GetGlobalPools()
+	{
+		static SizeClassPool* pPools = new SizeClassPool[NumSizeClasses];
+		return pPools;
+	}
+
+	//Trivially destructible so it can still be used after the thread cache was flushed
+	struct ThreadCache
+	{
+		Block* pFree[NumSizeClasses];
+		size_t Count[NumSizeClasses];
+		bool Destroyed;
+	};
+	thread_local ThreadCache t_Cache = {};
+
+	size_t GetSizeClass(size_t size)
+	{
+		size_t sizeClass = 0;
+		for (size_t blockSize = Delegates::SlabAllocator::MinBlockSize; blockSize < size; blockSize <<= 1)
+		{
+			++sizeClass;
+		}
+		return sizeClass < NumSizeClasses ? sizeClass : LargeSizeClass;
+	}
+
+	size_t& GetHeader(void* pPtr)
+	{
+		return *reinterpret_cast<size_t*>(static_cast<char*>(pPtr) - HeaderSize);
+	}
+
+	//Take up to count blocks from the global pool, carving a new chunk if it ran dry. Returns the amount taken
+	size_t TakeBlocks(size_t sizeClass, size_t count, Block*& pList)
+	{
+		SizeClassPool& pool = GetGlobalPools()[sizeClass];
+		std::lock_guard<std::mutex> lock(pool.Lock);
+		if (pool.pFree == nullptr)
+		{
+			const size_t stride = (Delegates::SlabAllocator::MinBlockSize << sizeClass) + HeaderSize;
+			const size_t blocks = ChunkSize / stride > BatchSize ? ChunkSize / stride : BatchSize;
+			char* pChunk = static_cast<char*>(malloc(blocks * stride));
+			if (pChunk == nullptr)
+			{
+				return 0;
+			}
+			for (size_t i = blocks; i > 0; --i)
+			{
+				char* pData = pChunk + (i - 1) * stride + HeaderSize;
+				GetHeader(pData) = sizeClass;
+				Block* pBlock = reinterpret_cast<Block*>(pData);
+				pBlock->pNext = pool.pFree;
+				pool.pFree = pBlock;
+			}
+		}
+		size_t taken = 0;
+		while (taken < count && pool.pFree != nullptr)
+		{
+			Block* pBlock = pool.pFree;
+			pool.pFree = pBlock->pNext;
+			pBlock->pNext = pList;
+			pList = pBlock;
+			++taken;
+		}
+		return taken;
+	}
+
+	//Give up to count blocks of the list back to the global pool
+	void ReturnBlocks(size_t sizeClass, size_t count, Block*& pList)
+	{
+		SizeClassPool& pool = GetGlobalPools()[sizeClass];
+		std::lock_guard<std::mutex> lock(pool.Lock);
+		for (size_t i = 0; i < count && pList != nullptr; ++i)
+		{
+			Block* pBlock = pList;
+			pList = pBlock->pNext;
+			pBlock->pNext = pool.pFree;
+			pool.pFree = pBlock;
+		}
+	}
+
+	//Returns the blocks of the thread cache to the global pool when the thread exits
+	struct ThreadCacheGuard
+	{
+		~ThreadCacheGuard()
+		{
+			for (size_t i = 0; i < NumSizeClasses; ++i)
+			{
+				ReturnBlocks(i, t_Cache.Count[i], t_Cache.pFree[i]);
+				t_Cache.Count[i] = 0;
+			}
+			t_Cache.Destroyed = true;
+		}
+	};
+	thread_local ThreadCacheGuard t_CacheGuard;
+
+	void* DefaultAlloc(size_t size)
+	{
+		return malloc(size);
+	}
+
+	void DefaultFree(void* pPtr)
+	{
+		free(pPtr);
+	}
+}
+
+void* Delegates::SlabAllocator::Allocate(size_t size)
+{
+	const size_t sizeClass = GetSizeClass(size);
+	if (sizeClass == LargeSizeClass)
+	{
+		char* pPtr = static_cast<char*>(malloc(size + HeaderSize));
+		if (pPtr == nullptr)
+		{
+			return nullptr;
+		}
+		GetHeader(pPtr + HeaderSize) = LargeSizeClass;
+		return pPtr + HeaderSize;
+	}
+
+	ThreadCache& cache = t_Cache;
+	if (cache.Destroyed)
+	{
+		Block* pBlock = nullptr;
+		TakeBlocks(sizeClass, 1, pBlock);
+		return pBlock;
+	}
+	if (cache.pFree[sizeClass] == nullptr)
+	{
+		//Make sure the guard gets constructed for this thread
+		(void)&t_CacheGuard;
+		cache.Count[sizeClass] += TakeBlocks(sizeClass, BatchSize, cache.pFree[sizeClass]);
+		if (cache.pFree[sizeClass] == nullptr)
+		{
+			return nullptr;
+		}
+	}
+	Block* pBlock = cache.pFree[sizeClass];
+	cache.pFree[sizeClass] = pBlock->pNext;
+	--cache.Count[sizeClass];
+	return pBlock;
+}
+
+void Delegates::SlabAllocator::Free(void* pPtr)
+{
+	if (pPtr == nullptr)
+	{
+		return;
+	}
+	const size_t sizeClass = GetHeader(pPtr);
+	if (sizeClass == LargeSizeClass)
+	{
+		free(static_cast<char*>(pPtr) - HeaderSize);
+		return;
+	}
+
+	Block* pBlock = static_cast<Block*>(pPtr);
+	ThreadCache& cache = t_Cache;
+	if (cache.Destroyed)
+	{
+		pBlock->pNext = nullptr;
+		ReturnBlocks(sizeClass, 1, pBlock);
+		return;
+	}
+	pBlock->pNext = cache.pFree[sizeClass];
+	cache.pFree[sizeClass] = pBlock;
+	if (++cache.Count[sizeClass] > 2 * BatchSize)
+	{
+		ReturnBlocks(sizeClass, BatchSize, cache.pFree[sizeClass]);
+		cache.Count[sizeClass] -= BatchSize;
+	}
+}
+
+namespace _DelegatesInteral
+{
+#ifdef DELEGATE_DEFAULT_SLAB_ALLOCATOR
+	void* (*Alloc)(size_t size) = &Delegates::SlabAllocator::Allocate;
+	void(*Free)(void* pPtr) = &Delegates::SlabAllocator::Free;
+#else
+	void* (*Alloc)(size_t size) = &DefaultAlloc;
+	void(*Free)(void* pPtr) = &DefaultFree;
+#endif
+}
+
+namespace
+{
+	//A range of a ParallelFor
+	struct Task
+	{
+		Delegates::IExecutor::TaskFunction pFunction;
+		void* pContext;
+		size_t Begin;
+		size_t End;
+		std::atomic<size_t>* pRemaining;
+	};
+
+	struct TaskQueue
+	{
+		std::mutex Lock;
+		std::deque<Task> Tasks;
+	};
+
+	void RunTask(const Task& task)
+	{
+		for (size_t i = task.Begin; i < task.End; ++i)
+		{
+			task.pFunction(task.pContext, i);
+		}
+		//Posted tasks have no ParallelFor waiting for them
+		if (task.pRemaining != nullptr)
+		{
+			task.pRemaining->fetch_sub(1, std::memory_order_release);
+		}
+	}
+}
+
+//One queue per worker and a last one shared by all other threads
+struct Delegates::WorkStealingExecutor::Context
+{
+	std::vector<std::thread> Workers;
+	std::unique_ptr<TaskQueue[]> pQueues;
+	size_t NumQueues = 0;
+
+	std::mutex SleepLock;
+	std::condition_variable WakeUp;
+	std::atomic<size_t> QueuedTasks{ 0 };
+	std::atomic<size_t> NextQueue{ 0 };
+	bool Stop = false;
+
+	//The owner takes new tasks from the back, thieves take the oldest (biggest) from the front
+	bool TryPop(size_t queueIndex, Task& task)
+	{
+		TaskQueue& queue = pQueues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (queue.Tasks.empty())
+		{
+			return false;
+		}
+		task = queue.Tasks.back();
+		queue.Tasks.pop_back();
+		QueuedTasks.fetch_sub(1);
+		return true;
+	}
+
+	bool TrySteal(size_t queueIndex, Task& task)
+	{
+		for (size_t i = 1; i < NumQueues; ++i)
+		{
+			TaskQueue& queue = pQueues[(queueIndex + i) % NumQueues];
+			std::lock_guard<std::mutex> lock(queue.Lock);
+			if (queue.Tasks.empty() == false)
+			{
+				task = queue.Tasks.front();
+				queue.Tasks.pop_front();
+				QueuedTasks.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool TryRunTask(size_t queueIndex)
+	{
+		Task task;
+		if (TryPop(queueIndex, task) || TrySteal(queueIndex, task))
+		{
+			RunTask(task);
+			return true;
+		}
+		return false;
+	}
+
+	void WorkerLoop(size_t queueIndex)
+	{
+		for (;;)
+		{
+			if (TryRunTask(queueIndex))
+			{
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(SleepLock);
+			WakeUp.wait(lock, [this]() { return Stop || QueuedTasks.load() > 0; });
+			if (Stop)
+			{
+				return;
+			}
+		}
+	}
+};
+
+Delegates::WorkStealingExecutor::WorkStealingExecutor(unsigned int threadCount)
+	: m_pContext(new Context())
+{
+	m_pContext->NumQueues = threadCount + 1;
+	m_pContext->pQueues.reset(new TaskQueue[m_pContext->NumQueues]);
+	m_pContext->Workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		Context* pContext = m_pContext;
+		m_pContext->Workers.emplace_back([pContext, i]() { pContext->WorkerLoop(i); });
+	}
+}
+
+Delegates::WorkStealingExecutor::~WorkStealingExecutor() noexcept
+{
+	//Finish posted tasks, somebody might be waiting for them
+	while (m_pContext->TryRunTask(m_pContext->NumQueues - 1))
+	{
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_pContext->SleepLock);
+		m_pContext->Stop = true;
+	}
+	m_pContext->WakeUp.notify_all();
+	for (std::thread& worker : m_pContext->Workers)
+	{
+		worker.join();
+	}
+	delete m_pContext;
+}
+
+void Delegates::WorkStealingExecutor::ParallelFor(size_t count, TaskFunction pFunction, void* pContext)
+{
+	const size_t numWorkers = m_pContext->Workers.size();
+	if (count <= 1 || numWorkers == 0)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			pFunction(pContext, i);
+		}
+		return;
+	}
+
+	//A few tasks per thread so threads that finish early can steal from the others
+	const size_t numTasks = std::min(count, (numWorkers + 1) * 4);
+	std::atomic<size_t> remaining(numTasks);
+	const size_t callerQueue = m_pContext->NumQueues - 1;
+	for (size_t i = 0; i < numTasks; ++i)
+	{
+		Task task = { pFunction, pContext, count * i / numTasks, count * (i + 1) / numTasks, &remaining };
+		TaskQueue& queue = m_pContext->pQueues[i % m_pContext->NumQueues];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		queue.Tasks.push_back(task);
+		m_pContext->QueuedTasks.fetch_add(1);
+	}
+	{
+		//Lock so a worker can't miss the wake up between checking QueuedTasks and going to sleep
+		std::lock_guard<std::mutex> lock(m_pContext->SleepLock);
+	}
+	m_pContext->WakeUp.notify_all();
+
+	//Help out until all tasks of this call are done
+	while (remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (m_pContext->TryRunTask(callerQueue) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void Delegates::WorkStealingExecutor::Post(TaskFunction pFunction, void* pContext)
+{
+	if (m_pContext->Workers.empty())
+	{
+		pFunction(pContext, 0);
+		return;
+	}
+	//Spread the posted tasks over the workers
+	const size_t queueIndex = m_pContext->NextQueue.fetch_add(1, std::memory_order_relaxed) % m_pContext->Workers.size();
+	{
+		TaskQueue& queue = m_pContext->pQueues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		Task task = { pFunction, pContext, 0, 1, nullptr };
+		queue.Tasks.push_back(task);
+		m_pContext->QueuedTasks.fetch_add(1);
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_pContext->SleepLock);
+	}
+	m_pContext->WakeUp.notify_one();
+}
+
+unsigned int Delegates::WorkStealingExecutor::GetThreadCount() const
+{
+	return (unsigned int)m_pContext->Workers.size();
+}
+
+Delegates::WorkStealingExecutor& Delegates::WorkStealingExecutor::GetDefault()
+{
+	static WorkStealingExecutor executor(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+	return executor;
+}
+
+//Events are stored back to back after the page header
+struct EventQueue::Page
+{
+	size_t Capacity;
+	size_t Used;
+
+	char* GetData()
+	{
+		return reinterpret_cast<char*>(this) + DataOffset;
+	}
+
+	static constexpr size_t DataOffset = 16;
+};
+
+//The pages of a Flush in progress, lives on the stack of the Flush
+struct EventQueue::FlushScope
+{
+	explicit FlushScope(EventQueue& queue)
+		: Queue(queue), pPrevious(queue.m_pFlushing)
+	{
+		Pages.swap(queue.m_Pages);
+		queue.m_Count = 0;
+		queue.m_pFlushing = this;
+	}
+
+	~FlushScope()
+	{
+		Queue.m_pFlushing = pPrevious;
+		Queue.ReleasePages(Pages);
+	}
+
+	FlushScope(const FlushScope& other) = delete;
+	FlushScope& operator=(const FlushScope& other) = delete;
+
+	EventQueue& Queue;
+	std::vector<Page*> Pages;
+	//Flush that was in progress when this one started
+	FlushScope* pPrevious;
+};
+
+EventQueue::EventQueue(size_t pageSize)
+	: m_pFlushing(nullptr), m_PageSize(pageSize), m_Count(0)
+{
+}
+
+EventQueue::~EventQueue() noexcept
+{
+	Clear();
+	for (Page* pPage : m_FreePages)
+	{
+		_DelegatesInteral::Free(pPage);
+	}
+}
+
+EventQueue::EventHeader* EventQueue::ReserveEvent(size_t argumentsSize)
+{
+	const size_t size = (HeaderSize + argumentsSize + Alignment - 1) & ~((size_t)Alignment - 1);
+	Page* pPage = m_Pages.empty() ? nullptr : m_Pages.back();
+	if (pPage == nullptr || pPage->Used + size > pPage->Capacity)
+	{
+		if (size <= m_PageSize && m_FreePages.empty() == false)
+		{
+			pPage = m_FreePages.back();
+			m_FreePages.pop_back();
+		}
+		else
+		{
+			//Events that don't fit in a page get a page of their own
+			const size_t capacity = size > m_PageSize ? size : m_PageSize;
+			pPage = static_cast<Page*>(_DelegatesInteral::Alloc(Page::DataOffset + capacity));
+			pPage->Capacity = capacity;
+		}
+		pPage->Used = 0;
+		m_Pages.push_back(pPage);
+	}
+	EventHeader* pEvent = reinterpret_cast<EventHeader*>(pPage->GetData() + pPage->Used);
+	pEvent->Size = size;
+	return pEvent;
+}
+
+void EventQueue::CommitEvent(EventHeader* pEvent)
+{
+	m_Pages.back()->Used += pEvent->Size;
+	++m_Count;
+}
+
+void EventQueue::Flush()
+{
+	//Events queued by the listeners go to new pages and wait for the next Flush
+	FlushScope flush(*this);
+	for (Page* pPage : flush.Pages)
+	{
+		for (size_t offset = 0; offset < pPage->Used;)
+		{
+			EventHeader* pEvent = reinterpret_cast<EventHeader*>(pPage->GetData() + offset);
+			offset += pEvent->Size;
+			pEvent->pDispatch(pEvent, true);
+		}
+	}
+}
+
+void EventQueue::FlushGrouped()
+{
+	struct GroupedEvent
+	{
+		void* pTarget;
+		size_t Index;
+		EventHeader* pEvent;
+	};
+
+	std::vector<GroupedEvent> events;
+	events.reserve(m_Count);
+	FlushScope flush(*this);
+	for (Page* pPage : flush.Pages)
+	{
+		for (size_t offset = 0; offset < pPage->Used;)
+		{
+			EventHeader* pEvent = reinterpret_cast<EventHeader*>(pPage->GetData() + offset);
+			offset += pEvent->Size;
+			events.push_back(GroupedEvent{ pEvent->pTarget, events.size(), pEvent });
+		}
+	}
+	std::sort(events.begin(), events.end(), [](const GroupedEvent& a, const GroupedEvent& b)
+		{
+			return a.pTarget != b.pTarget ? std::less<void*>()(a.pTarget, b.pTarget) : a.Index < b.Index;
+		});
+
+	for (const GroupedEvent& event : events)
+	{
+		event.pEvent->pDispatch(event.pEvent, true);
+	}
+}
+
+void EventQueue::Clear()
+{
+	std::vector<Page*> pages;
+	pages.swap(m_Pages);
+	m_Count = 0;
+	for (Page* pPage : pages)
+	{
+		for (size_t offset = 0; offset < pPage->Used;)
+		{
+			EventHeader* pEvent = reinterpret_cast<EventHeader*>(pPage->GetData() + offset);
+			offset += pEvent->Size;
+			pEvent->pDispatch(pEvent, false);
+		}
+	}
+	ReleasePages(pages);
+}
+
+void EventQueue::Discard(const void* pTarget)
+{
+	auto discard = [pTarget](std::vector<Page*>& pages)
+	{
+		for (Page* pPage : pages)
+		{
+			for (size_t offset = 0; offset < pPage->Used;)
+			{
+				EventHeader* pEvent = reinterpret_cast<EventHeader*>(pPage->GetData() + offset);
+				offset += pEvent->Size;
+				if (pEvent->pTarget == pTarget)
+				{
+					pEvent->pTarget = nullptr;
+				}
+			}
+		}
+	};
+	discard(m_Pages);
+	//Also the events of every Flush in progress that didn't run yet
+	for (FlushScope* pFlush = m_pFlushing; pFlush != nullptr; pFlush = pFlush->pPrevious)
+	{
+		discard(pFlush->Pages);
+	}
+}
+
+void EventQueue::ReleasePages(std::vector<Page*>& pages)
+{
+	for (Page* pPage : pages)
+	{
+		if (pPage->Capacity == m_PageSize)
+		{
+			m_FreePages.push_back(pPage);
+		}
+		else
+		{
+			_DelegatesInteral::Free(pPage);
+		}
+	}
+	pages.clear();
+}
+
+DelegateDispatcher::DelegateDispatcher()
+	: m_pHead(&m_Stub), m_pTail(&m_Stub), m_Owner(std::this_thread::get_id())
+{
+	m_Stub.pNext.store(nullptr, std::memory_order_relaxed);
+	m_Stub.pFunction = nullptr;
+}
+
+DelegateDispatcher::~DelegateDispatcher() noexcept
+{
+	while (Node* pNode = Pop())
+	{
+		pNode->pFunction(pNode, false);
+	}
+}
+
+void DelegateDispatcher::Push(Node* pNode)
+{
+	pNode->pNext.store(nullptr, std::memory_order_relaxed);
+	Node* pPrevious = m_pHead.exchange(pNode, std::memory_order_acq_rel);
+	//Until this store the consumer can't see the node, Pop treats that as empty
+	pPrevious->pNext.store(pNode, std::memory_order_release);
+}
+
+DelegateDispatcher::Node* DelegateDispatcher::Pop()
+{
+	Node* pTail = m_pTail;
+	Node* pNext = pTail->pNext.load(std::memory_order_acquire);
+	if (pTail == &m_Stub)
+	{
+		if (pNext == nullptr)
+		{
+			return nullptr;
+		}
+		m_pTail = pNext;
+		pTail = pNext;
+		pNext = pNext->pNext.load(std::memory_order_acquire);
+	}
+	if (pNext != nullptr)
+	{
+		m_pTail = pNext;
+		return pTail;
+	}
+	if (pTail != m_pHead.load(std::memory_order_acquire))
+	{
+		return nullptr;
+	}
+	//The tail is the last node, push the stub behind it so the tail can be taken out
+	Push(&m_Stub);
+	pNext = pTail->pNext.load(std::memory_order_acquire);
+	if (pNext != nullptr)
+	{
+		m_pTail = pNext;
+		return pTail;
+	}
+	return nullptr;
+}
+
+size_t DelegateDispatcher::Dispatch()
+{
+	DELEGATE_ASSERT(IsOwnerThread(), "Dispatch must be called on the thread that owns the dispatcher");
+	//Everything up to the current head was posted before the call
+	Node* pLast = m_pHead.load(std::memory_order_acquire);
+	if (pLast == &m_Stub)
+	{
+		return 0;
+	}
+	size_t count = 0;
+	while (Node* pNode = Pop())
+	{
+		const bool isLast = pNode == pLast;
+		pNode->pFunction(pNode, true);
+		++count;
+		if (isLast)
+		{
+			break;
+		}
+	}
+	return count;
+}
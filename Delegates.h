@@ -9,18 +9,35 @@ Override default asset
 Override default static_assert
 #define DELEGATE_STATIC_ASSERT(expression, msg)
 
-Set inline allocator size (default: 32)
+Set default inline allocator size (default: 32)
+Can be set per type with InlineDelegate and InlineMulticastDelegate
 #define DELEGATE_INLINE_ALLOCATION_SIZE
 
 Reassign allocation functions:
 Delegates::SetAllocationCallbacks(allocFunction, freeFunc);
 
+Use the built-in size-class pool allocator for heap allocated delegates:
+Delegates::SlabAllocator::Install();
+or define when compiling Delegates.cpp:
+#define DELEGATE_DEFAULT_SLAB_ALLOCATOR
+
+Use std::pmr::memory_resource for allocations (default: on when <memory_resource> is available in C++17)
+#define DELEGATE_PMR
+MulticastDelegate<int> multicast(&resource);
+Delegates::ScopedMemoryResource scope(&resource);
+
 
 // USAGE
 
 ## Classes ##
 - ```Delegate<RetVal, Args>```
 - ```MulticastDelegate<Args>```
+- ```CompactDelegate<RetVal, Args>``` and ```InlineCompactDelegate<StorageSize, RetVal, Args>```
+- ```CompactMulticastDelegate<Args>```
+- ```InlineDelegate<InlineSize, RetVal, Args>``` and ```InlineMulticastDelegate<InlineSize, Args>``` to pick the inline allocation size per type
+- ```MulticastDelegateRet<RetVal, Args>```
+- ```StaticMulticastDelegate<void(*)(Args), &Functions...>```
+- ```ConcurrentMulticastDelegate<Args>```
 
 ## Features ##
 - Support for:
@@ -29,6 +46,7 @@ Delegates::SetAllocationCallbacks(allocFunction, freeFunc);
 	- Lambda's
 	- std::shared_ptr
 - Delegate object is allocated inline if it is under 32 bytes
+- Execute calls the bound object through a single function pointer, no virtual dispatch
 - Add payload to delegate during bind-time
 - Move operations enable optimization
 
@@ -84,7 +102,16 @@ Raw delegate payload: 10
 
 #include <vector>
 #include <memory>
+#include <cstdlib>
+#include <cstring>
 #include <tuple>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 ///////////////////////////////////////////////////////////////
 //////////////////// DEFINES SECTION //////////////////////////
@@ -109,24 +136,76 @@ Raw delegate payload: 10
 #define DELEGATE_INLINE_ALLOCATION_SIZE 32
 #endif
 
+//Support for std::pmr memory resources.
+//Enabled by default when <memory_resource> is available (C++17)
+#ifndef DELEGATE_PMR
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#if defined(__has_include)
+#if __has_include(<memory_resource>)
+#define DELEGATE_PMR 1
+#endif
+#endif
+#endif
+#endif
+#ifndef DELEGATE_PMR
+#define DELEGATE_PMR 0
+#endif
+
+//Support for template<auto> (C++17), used for the shorter StaticMulticast alias and Delegate::Create<&Function>
+#ifndef DELEGATE_AUTO_TEMPLATE
+#if defined(__cpp_nontype_template_parameter_auto) || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define DELEGATE_AUTO_TEMPLATE 1
+#else
+#define DELEGATE_AUTO_TEMPLATE 0
+#endif
+#endif
+
+//Exceptions thrown by asynchronous delegate calls are caught and rethrown by DelegateFuture::Get
+//Disabled when compiling without exceptions
+#ifndef DELEGATE_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define DELEGATE_EXCEPTIONS 1
+#else
+#define DELEGATE_EXCEPTIONS 0
+#endif
+#endif
+
+#if DELEGATE_PMR
+#include <memory_resource>
+#endif
+
+#if DELEGATE_EXCEPTIONS
+#include <exception>
+#endif
+
 #define DECLARE_DELEGATE(name, ...) \
-using name = Delegate<void, __VA_ARGS__>
+using name = Delegate<void, ##__VA_ARGS__>
 
 #define DECLARE_DELEGATE_RET(name, retValue, ...) \
-using name = Delegate<retValue, __VA_ARGS__>
+using name = Delegate<retValue, ##__VA_ARGS__>
 
 #define DECLARE_MULTICAST_DELEGATE(name, ...) \
 using name = MulticastDelegate<__VA_ARGS__>; \
 using name ## Delegate = MulticastDelegate<__VA_ARGS__>::DelegateT
 
+#define DECLARE_MULTICAST_DELEGATE_RET(name, retValue, ...) \
+using name = MulticastDelegateRet<retValue, ##__VA_ARGS__>; \
+using name ## Delegate = MulticastDelegateRet<retValue, ##__VA_ARGS__>::DelegateT
+
+#define DECLARE_CONCURRENT_MULTICAST_DELEGATE(name, ...) \
+using name = ConcurrentMulticastDelegate<__VA_ARGS__>; \
+using name ## Delegate = ConcurrentMulticastDelegate<__VA_ARGS__>::DelegateT
+
 #define DECLARE_EVENT(name, ownerType, ...) \
 class name : public MulticastDelegate<__VA_ARGS__> \
 { \
 private: \
 	friend class ownerType; \
-	using MulticastDelegate::Broadcast; \
-	using MulticastDelegate::RemoveAll; \
-	using MulticastDelegate::Remove; \
+	using InlineMulticastDelegate::Broadcast; \
+	using InlineMulticastDelegate::BroadcastBatch; \
+	using InlineMulticastDelegate::BroadcastParallel; \
+	using InlineMulticastDelegate::RemoveAll; \
+	using InlineMulticastDelegate::Remove; \
 };
 
 ///////////////////////////////////////////////////////////////
@@ -156,8 +235,109 @@ namespace _DelegatesInteral
 		using Type = RetVal(Object::*)(Args...);
 	};
 
-	static void* (*Alloc)(size_t size) = [](size_t size) { return malloc(size); };
-	static void(*Free)(void* pPtr) = [](void* pPtr) { free(pPtr); };
+	//How Broadcast takes an argument that every listener receives a copy of
+	//References, scalars and small trivially copyable types are passed by value, anything else by const reference
+	//so the only copies are the ones made for the listeners.
+	//Scalars and references are decided first so they can be incomplete types.
+	template<typename T, bool IsCheap = std::is_reference<T>::value || std::is_scalar<T>::value>
+	struct Parameter
+	{
+		using Type = T;
+	};
+
+	template<typename T>
+	struct Parameter<T, false>
+	{
+		using Type = typename std::conditional<std::is_trivially_copyable<T>::value && sizeof(T) <= 2 * sizeof(void*), T, const T&>::type;
+	};
+
+	template<typename T>
+	using ParameterType = typename Parameter<T>::Type;
+
+	//True if moving the types is equivalent to copying their bytes and forgetting the source.
+	//Only trivially copyable types are proven to be. Anything else (eg. std::string with SSO, self-referencing types)
+	//has to go through its move constructor.
+	template<typename... Ts>
+	struct IsTriviallyRelocatable;
+
+	template<>
+	struct IsTriviallyRelocatable<> : std::true_type
+	{};
+
+	template<typename T, typename... Ts>
+	struct IsTriviallyRelocatable<T, Ts...>
+		: std::integral_constant<bool, std::is_trivially_copyable<T>::value && IsTriviallyRelocatable<Ts...>::value>
+	{};
+
+	//True if the function can be called with the arguments in the tuple
+	//Used with a const lambda and const payload to find lambdas that can change themselves when they are executed.
+	template<typename Function, typename ArgumentTuple, typename = void>
+	struct IsCallable : std::false_type
+	{};
+
+	template<typename Function, typename... Args>
+	struct IsCallable<Function, std::tuple<Args...>, decltype(void(std::declval<Function>()(std::declval<Args>()...)))> : std::true_type
+	{};
+
+	//Defined in Delegates.cpp so every translation unit shares the same callbacks
+	extern void* (*Alloc)(size_t size);
+	extern void(*Free)(void* pPtr);
+
+#if DELEGATE_PMR
+	template<typename T>
+	using Vector = std::pmr::vector<T>;
+#else
+	template<typename T>
+	using Vector = std::vector<T>;
+#endif
+
+#if DELEGATE_PMR
+	//Memory resource used for heap allocations of delegates on this thread. nullptr uses Alloc/Free
+	inline std::pmr::memory_resource*& CurrentMemoryResource()
+	{
+		thread_local std::pmr::memory_resource* pResource = nullptr;
+		return pResource;
+	}
+#endif
+
+	//Makes delegates bound during its lifetime allocate from the given memory resource
+	//Does nothing without DELEGATE_PMR
+	class MemoryResourceScope
+	{
+	public:
+#if DELEGATE_PMR
+		explicit MemoryResourceScope(std::pmr::memory_resource* pResource)
+			: m_pPrevious(CurrentMemoryResource()), m_Active(true)
+		{
+			CurrentMemoryResource() = pResource;
+		}
+
+		MemoryResourceScope(MemoryResourceScope&& other) noexcept
+			: m_pPrevious(other.m_pPrevious), m_Active(other.m_Active)
+		{
+			other.m_Active = false;
+		}
+
+		~MemoryResourceScope()
+		{
+			if (m_Active)
+			{
+				CurrentMemoryResource() = m_pPrevious;
+			}
+		}
+
+	private:
+		std::pmr::memory_resource* m_pPrevious;
+		bool m_Active;
+#else
+		explicit MemoryResourceScope(void*)
+		{}
+
+		~MemoryResourceScope()
+		{}
+#endif
+		MemoryResourceScope& operator=(const MemoryResourceScope& other) = delete;
+	};
 }
 
 namespace Delegates
@@ -169,6 +349,283 @@ namespace Delegates
 		_DelegatesInteral::Alloc = allocateCallback;
 		_DelegatesInteral::Free = freeCallback;
 	}
+
+#if DELEGATE_PMR
+	//Delegates bound on this thread while the scope is alive are heap allocated from the memory resource
+	//The resource is remembered by the allocation, so the delegate can be released anywhere.
+	//Copies allocate from the resource of the scope they are made in.
+	using ScopedMemoryResource = _DelegatesInteral::MemoryResourceScope;
+#endif
+
+	//Size-class pool allocator for delegates that don't fit in their inline buffer
+	//Blocks are carved from big chunks and cached per thread,
+	//so binding large lambdas every frame doesn't hit the general purpose heap.
+	//Memory of the chunks is never given back to the system.
+	//Install it before the first delegate is heap allocated, blocks can't be freed by another allocator.
+	//Define DELEGATE_DEFAULT_SLAB_ALLOCATOR when compiling Delegates.cpp to make it the default.
+	class SlabAllocator
+	{
+	public:
+		//Smallest size class, the others are powers of two up to MaxBlockSize
+		constexpr static const size_t MinBlockSize = 64;
+		//Allocations bigger than this fall back to malloc
+		constexpr static const size_t MaxBlockSize = 4096;
+
+		static void* Allocate(size_t size);
+		static void Free(void* pPtr);
+
+		static void Install()
+		{
+			SetAllocationCallbacks(&SlabAllocator::Allocate, &SlabAllocator::Free);
+		}
+	};
+
+	//Non-owning view over contiguous elements, used to broadcast a batch of arguments
+	//Can be created from anything with data() and size() like std::vector and std::array
+	template<typename T>
+	class Span
+	{
+	public:
+		constexpr Span() noexcept
+			: m_pData(nullptr), m_Size(0)
+		{}
+
+		constexpr Span(T* pData, size_t size) noexcept
+			: m_pData(pData), m_Size(size)
+		{}
+
+		template<size_t N>
+		constexpr Span(T(&data)[N]) noexcept
+			: m_pData(data), m_Size(N)
+		{}
+
+		template<typename Container, typename = typename std::enable_if<
+			!std::is_same<typename std::decay<Container>::type, Span>::value &&
+			std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>::type>
+		constexpr Span(Container&& container) noexcept
+			: m_pData(container.data()), m_Size(container.size())
+		{}
+
+		constexpr T* data() const noexcept { return m_pData; }
+		constexpr size_t size() const noexcept { return m_Size; }
+		constexpr bool empty() const noexcept { return m_Size == 0; }
+		constexpr T* begin() const noexcept { return m_pData; }
+		constexpr T* end() const noexcept { return m_pData + m_Size; }
+		constexpr T& operator[](size_t index) const noexcept { return m_pData[index]; }
+
+	private:
+		T* m_pData;
+		size_t m_Size;
+	};
+
+	//Combiners aggregate the results of a MulticastDelegateRet broadcast without allocating
+	//Add receives the result of every delegate in order and returns false to stop the broadcast early.
+	//GetResult returns the aggregated value. Write your own with the same interface.
+
+	//Result of the first delegate, or a default constructed value without delegates
+	template<typename T>
+	class First
+	{
+	public:
+		using ResultType = T;
+
+		bool Add(T&& value)
+		{
+			m_Value = std::move(value);
+			m_HasValue = true;
+			return false;
+		}
+
+		bool HasValue() const { return m_HasValue; }
+		T GetResult() const { return m_Value; }
+
+	private:
+		T m_Value{};
+		bool m_HasValue = false;
+	};
+
+	//Result of the last delegate, or a default constructed value without delegates
+	template<typename T>
+	class Last
+	{
+	public:
+		using ResultType = T;
+
+		bool Add(T&& value)
+		{
+			m_Value = std::move(value);
+			m_HasValue = true;
+			return true;
+		}
+
+		bool HasValue() const { return m_HasValue; }
+		T GetResult() const { return m_Value; }
+
+	private:
+		T m_Value{};
+		bool m_HasValue = false;
+	};
+
+	//Sum of all results, starting from a default constructed value
+	template<typename T>
+	class Sum
+	{
+	public:
+		using ResultType = T;
+
+		bool Add(T&& value)
+		{
+			m_Value += value;
+			return true;
+		}
+
+		T GetResult() const { return m_Value; }
+
+	private:
+		T m_Value{};
+	};
+
+	//Smallest result, or a default constructed value without delegates
+	template<typename T>
+	class Min
+	{
+	public:
+		using ResultType = T;
+
+		bool Add(T&& value)
+		{
+			if (m_HasValue == false || value < m_Value)
+			{
+				m_Value = std::move(value);
+				m_HasValue = true;
+			}
+			return true;
+		}
+
+		bool HasValue() const { return m_HasValue; }
+		T GetResult() const { return m_Value; }
+
+	private:
+		T m_Value{};
+		bool m_HasValue = false;
+	};
+
+	//Largest result, or a default constructed value without delegates
+	template<typename T>
+	class Max
+	{
+	public:
+		using ResultType = T;
+
+		bool Add(T&& value)
+		{
+			if (m_HasValue == false || m_Value < value)
+			{
+				m_Value = std::move(value);
+				m_HasValue = true;
+			}
+			return true;
+		}
+
+		bool HasValue() const { return m_HasValue; }
+		T GetResult() const { return m_Value; }
+
+	private:
+		T m_Value{};
+		bool m_HasValue = false;
+	};
+
+	//True if all results are true, stops at the first false. True without delegates
+	class AllOf
+	{
+	public:
+		using ResultType = bool;
+
+		bool Add(bool value)
+		{
+			m_Value = value;
+			return value;
+		}
+
+		bool GetResult() const { return m_Value; }
+
+	private:
+		bool m_Value = true;
+	};
+
+	//Writes the results in order into the span, stops once it is full. Returns the amount written
+	template<typename T>
+	class WriteToSpan
+	{
+	public:
+		using ResultType = size_t;
+
+		explicit WriteToSpan(Span<T> output)
+			: m_Output(output), m_Count(0)
+		{}
+
+		bool Add(T&& value)
+		{
+			if (m_Count < m_Output.size())
+			{
+				m_Output[m_Count++] = std::move(value);
+			}
+			return m_Count < m_Output.size();
+		}
+
+		size_t GetResult() const { return m_Count; }
+
+	private:
+		Span<T> m_Output;
+		size_t m_Count;
+	};
+
+	//Runs tasks for MulticastDelegate::BroadcastParallel
+	//Implement to run the delegates on your own job system
+	class IExecutor
+	{
+	public:
+		using TaskFunction = void(*)(void* pContext, size_t index);
+
+		virtual ~IExecutor() noexcept = default;
+
+		//Call pFunction for every index in [0, count), possibly in parallel
+		//Must return only after all calls finished and may be called from within a task
+		virtual void ParallelFor(size_t count, TaskFunction pFunction, void* pContext) = 0;
+
+		//Call pFunction once with index 0, possibly on another thread, without waiting for it
+		//Used by Delegate::ExecuteOn. Runs it right away by default.
+		virtual void Post(TaskFunction pFunction, void* pContext)
+		{
+			pFunction(pContext, 0);
+		}
+	};
+
+	//Thread pool where every worker has its own queue of tasks and steals from the others when it runs dry
+	//The thread calling ParallelFor works on the tasks as well until they are all done
+	//Implementation is in Delegates.cpp
+	class WorkStealingExecutor : public IExecutor
+	{
+	public:
+		//Without worker threads, ParallelFor runs everything on the calling thread
+		explicit WorkStealingExecutor(unsigned int threadCount);
+		~WorkStealingExecutor() noexcept;
+
+		WorkStealingExecutor(const WorkStealingExecutor& other) = delete;
+		WorkStealingExecutor& operator=(const WorkStealingExecutor& other) = delete;
+
+		virtual void ParallelFor(size_t count, TaskFunction pFunction, void* pContext) override;
+		virtual void Post(TaskFunction pFunction, void* pContext) override;
+
+		unsigned int GetThreadCount() const;
+
+		//Shared executor with a worker for every hardware thread except the calling one
+		static WorkStealingExecutor& GetDefault();
+
+	private:
+		struct Context;
+		Context* m_pContext;
+	};
 }
 
 class IDelegateBase
@@ -178,6 +635,12 @@ public:
 	virtual ~IDelegateBase() noexcept = default;
 	virtual const void* GetOwner() const { return nullptr; }
 	virtual void Clone(void* pDestination) = 0;
+	//True for a SharedDelegate, see InlineDelegate::Share
+	virtual bool IsShared() const { return false; }
+	//True if executing can change the delegate itself: a mutable lambda or a lambda that takes its payload by non-const reference
+	//Payloads of functions always match their parameters, so those only change what the payload refers to.
+	//A shared delegate copies the delegates that can change before executing them, see InlineDelegate::Share
+	virtual bool IsMutable() const { return false; }
 };
 
 //Base type for delegates
@@ -185,6 +648,9 @@ template<typename RetVal, typename... Args>
 class IDelegate : public IDelegateBase
 {
 public:
+	//True when the bound object can go away (std::weak_ptr), TryExecute is provided in that case
+	static constexpr bool CanExpire = false;
+
 	virtual RetVal Execute(Args&&... args) = 0;
 };
 
@@ -197,6 +663,9 @@ class StaticDelegate<RetVal(Args...), Args2...> : public IDelegate<RetVal, Args.
 public:
 	using DelegateFunction = RetVal(*)(Args..., Args2...);
 
+	//The vptr can be copied as is, so this only depends on the members
+	static constexpr bool IsTriviallyRelocatable = _DelegatesInteral::IsTriviallyRelocatable<DelegateFunction, Args2...>::value;
+
 	StaticDelegate(DelegateFunction function, Args2&&... payload)
 		: m_Function(function), m_Payload(std::forward<Args2>(payload)...)
 	{}
@@ -235,6 +704,8 @@ class RawDelegate<IsConst, T, RetVal(Args...), Args2...> : public IDelegate<RetV
 public:
 	using DelegateFunction = typename _DelegatesInteral::MemberFunction<IsConst, T, RetVal, Args..., Args2...>::Type;
 
+	static constexpr bool IsTriviallyRelocatable = _DelegatesInteral::IsTriviallyRelocatable<T*, DelegateFunction, Args2...>::value;
+
 	RawDelegate(T* pObject, DelegateFunction function, Args2&&... payload)
 		: m_pObject(pObject), m_Function(function), m_Payload(std::forward<Args2>(payload)...)
 	{}
@@ -269,6 +740,92 @@ private:
 	std::tuple<Args2...> m_Payload;
 };
 
+//Static delegate where the function is a template argument
+//Only the payload is stored and the function is called directly so it can be inlined
+//The payload is a base so it takes no space when there is none
+template<typename FunctionT, FunctionT Function, typename RetVal, typename... Args2>
+class DirectStaticDelegate;
+
+template<typename FunctionT, FunctionT Function, typename RetVal, typename... Args, typename... Args2>
+class DirectStaticDelegate<FunctionT, Function, RetVal(Args...), Args2...> : public IDelegate<RetVal, Args...>, private std::tuple<Args2...>
+{
+	using Payload = std::tuple<Args2...>;
+
+public:
+	static constexpr bool IsTriviallyRelocatable = _DelegatesInteral::IsTriviallyRelocatable<Args2...>::value;
+
+	DirectStaticDelegate(Args2&&... payload)
+		: Payload(std::forward<Args2>(payload)...)
+	{}
+
+	DirectStaticDelegate(const Payload& payload)
+		: Payload(payload)
+	{}
+
+	virtual RetVal Execute(Args&&... args) override
+	{
+		return Execute_Internal(std::forward<Args>(args)..., std::index_sequence_for<Args2...>());
+	}
+
+	virtual void Clone(void* pDestination) override
+	{
+		new (pDestination) DirectStaticDelegate(static_cast<const Payload&>(*this));
+	}
+
+private:
+	template<std::size_t... Is>
+	RetVal Execute_Internal(Args&&... args, std::index_sequence<Is...>)
+	{
+		return static_cast<RetVal>(Function(std::forward<Args>(args)..., std::get<Is>(static_cast<Payload&>(*this))...));
+	}
+};
+
+//Raw delegate where the member function is a template argument
+//Only the object pointer and payload are stored and the function is called directly so it can be inlined
+template<typename T, typename FunctionT, FunctionT Function, typename RetVal, typename... Args2>
+class DirectRawDelegate;
+
+template<typename T, typename FunctionT, FunctionT Function, typename RetVal, typename... Args, typename... Args2>
+class DirectRawDelegate<T, FunctionT, Function, RetVal(Args...), Args2...> : public IDelegate<RetVal, Args...>, private std::tuple<Args2...>
+{
+	using Payload = std::tuple<Args2...>;
+
+public:
+	static constexpr bool IsTriviallyRelocatable = _DelegatesInteral::IsTriviallyRelocatable<T*, Args2...>::value;
+
+	DirectRawDelegate(T* pObject, Args2&&... payload)
+		: Payload(std::forward<Args2>(payload)...), m_pObject(pObject)
+	{}
+
+	DirectRawDelegate(T* pObject, const Payload& payload)
+		: Payload(payload), m_pObject(pObject)
+	{}
+
+	virtual RetVal Execute(Args&&... args) override
+	{
+		return Execute_Internal(std::forward<Args>(args)..., std::index_sequence_for<Args2...>());
+	}
+
+	virtual const void* GetOwner() const override
+	{
+		return m_pObject;
+	}
+
+	virtual void Clone(void* pDestination) override
+	{
+		new (pDestination) DirectRawDelegate(m_pObject, static_cast<const Payload&>(*this));
+	}
+
+private:
+	template<std::size_t... Is>
+	RetVal Execute_Internal(Args&&... args, std::index_sequence<Is...>)
+	{
+		return static_cast<RetVal>((m_pObject->*Function)(std::forward<Args>(args)..., std::get<Is>(static_cast<Payload&>(*this))...));
+	}
+
+	T* m_pObject;
+};
+
 template<typename TLambda, typename RetVal, typename... Args>
 class LambdaDelegate;
 
@@ -276,6 +833,8 @@ template<typename TLambda, typename RetVal, typename... Args, typename... Args2>
 class LambdaDelegate<TLambda, RetVal(Args...), Args2...> : public IDelegate<RetVal, Args...>
 {
 public:
+	static constexpr bool IsTriviallyRelocatable = _DelegatesInteral::IsTriviallyRelocatable<TLambda, Args2...>::value;
+
 	explicit LambdaDelegate(TLambda&& lambda, Args2&&... payload)
 		: m_Lambda(std::forward<TLambda>(lambda)),
 		m_Payload(std::forward<Args2>(payload)...)
@@ -296,6 +855,11 @@ public:
 		new (pDestination) LambdaDelegate(m_Lambda, m_Payload);
 	}
 
+	virtual bool IsMutable() const override
+	{
+		return !_DelegatesInteral::IsCallable<const TLambda&, std::tuple<Args&&..., const Args2&...>>::value;
+	}
+
 private:
 	template<std::size_t... Is>
 	RetVal Execute_Internal(Args&&... args, std::index_sequence<Is...>)
@@ -316,6 +880,10 @@ class SPDelegate<IsConst, T, RetVal(Args...), Args2...> : public IDelegate<RetVa
 public:
 	using DelegateFunction = typename _DelegatesInteral::MemberFunction<IsConst, T, RetVal, Args..., Args2...>::Type;
 
+	//std::weak_ptr is not trivially copyable
+	static constexpr bool IsTriviallyRelocatable = false;
+	static constexpr bool CanExpire = true;
+
 	SPDelegate(std::shared_ptr<T> pObject, DelegateFunction pFunction, Args2&&... payload)
 		: m_pObject(pObject),
 		m_pFunction(pFunction),
@@ -330,12 +898,43 @@ public:
 
 	virtual RetVal Execute(Args&&... args) override
 	{
-		return Execute_Internal(std::forward<Args>(args)..., std::index_sequence_for<Args2...>());
+		std::shared_ptr<T> pPinned = m_pObject.lock();
+		if (pPinned == nullptr)
+		{
+			return RetVal();
+		}
+		return Execute_Internal(pPinned.get(), std::forward<Args>(args)..., std::index_sequence_for<Args2...>());
+	}
+
+	//Execute the delegate if the object is still alive
+	//Returns false without executing if the object expired
+	bool TryExecute(Args&&... args)
+	{
+		std::shared_ptr<T> pPinned = m_pObject.lock();
+		if (pPinned == nullptr)
+		{
+			return false;
+		}
+		Execute_Internal(pPinned.get(), std::forward<Args>(args)..., std::index_sequence_for<Args2...>());
+		return true;
+	}
+
+	//Execute the delegate with a return value if the object is still alive
+	//Sets isAlive to false and returns a default constructed value without executing if the object expired
+	RetVal TryExecute(bool& isAlive, Args&&... args)
+	{
+		std::shared_ptr<T> pPinned = m_pObject.lock();
+		if (pPinned == nullptr)
+		{
+			isAlive = false;
+			return RetVal();
+		}
+		return Execute_Internal(pPinned.get(), std::forward<Args>(args)..., std::index_sequence_for<Args2...>());
 	}
 
 	virtual const void* GetOwner() const override
 	{
-		return m_pObject.expired() ? nullptr : m_pObject.lock().get();
+		return m_pObject.lock().get();
 	}
 
 	virtual void Clone(void* pDestination) override
@@ -344,18 +943,11 @@ public:
 	}
 
 private:
+	//Only one lock() per call, the object is pinned by the caller
 	template<std::size_t... Is>
-	RetVal Execute_Internal(Args&&... args, std::index_sequence<Is...>)
+	RetVal Execute_Internal(T* pObject, Args&&... args, std::index_sequence<Is...>)
 	{
-		if (m_pObject.expired())
-		{
-			return RetVal();
-		}
-		else
-		{
-			std::shared_ptr<T> pPinned = m_pObject.lock();
-			return (pPinned.get()->*m_pFunction)(std::forward<Args>(args)..., std::get<Is>(m_Payload)...);
-		}
+		return (pObject->*m_pFunction)(std::forward<Args>(args)..., std::get<Is>(m_Payload)...);
 	}
 
 	std::weak_ptr<T> m_pObject;
@@ -363,27 +955,222 @@ private:
 	std::tuple<Args2...> m_Payload;
 };
 
-//A handle to a delegate used for a multicast delegate
-//Static ID so that every handle is unique
-class DelegateHandle
+//Delegate that receives a whole batch of arguments at once, see MulticastDelegate::AddBatch
+//A single Broadcast is passed on as a batch of one
+template<typename BatchDelegateT, typename... Args>
+class BatchDelegate : public IDelegate<void, Args...>
 {
 public:
-	constexpr DelegateHandle() noexcept
-		: m_Id(INVALID_ID)
+	using BatchT = Delegates::Span<const std::tuple<Args...>>;
+
+	static constexpr bool IsTriviallyRelocatable = false;
+	//The bound delegate can be bound to a std::shared_ptr
+	static constexpr bool CanExpire = true;
+
+	explicit BatchDelegate(BatchDelegateT&& batchDelegate)
+		: m_Delegate(std::move(batchDelegate))
+	{}
+
+	virtual void Execute(Args&&... args) override
 	{
+		TryExecute(std::forward<Args>(args)...);
 	}
 
-	explicit DelegateHandle(bool /*generateId*/) noexcept
-		: m_Id(GetNewID())
+	bool TryExecute(Args&&... args)
 	{
+		std::tuple<Args...> arguments(std::forward<Args>(args)...);
+		return m_Delegate.ExecuteIfAlive(BatchT(&arguments, 1));
 	}
 
-	~DelegateHandle() noexcept = default;
-	DelegateHandle(const DelegateHandle& other) = default;
-	DelegateHandle& operator=(const DelegateHandle& other) = default;
-
-	DelegateHandle(DelegateHandle&& other) noexcept
-		: m_Id(other.m_Id)
+	//Returns false without executing if the object of the bound delegate expired
+	bool ExecuteBatch(const BatchT& batch)
+	{
+		return m_Delegate.ExecuteIfAlive(batch);
+	}
+
+	virtual const void* GetOwner() const override
+	{
+		return m_Delegate.GetOwner();
+	}
+
+	virtual void Clone(void* pDestination) override
+	{
+		new (pDestination) BatchDelegate(*this);
+	}
+
+private:
+	BatchDelegateT m_Delegate;
+};
+
+//Delegate that shares the delegate it wraps with all its copies, see InlineDelegate::Share
+//Copies only increment a reference count, so copying never allocates.
+//A delegate that can change itself when executed is copied first while other copies share it.
+template<typename DelegateT, typename RetVal, typename... Args>
+class SharedDelegate : public IDelegate<RetVal, Args...>
+{
+public:
+	//A vptr and a pointer
+	static constexpr bool IsTriviallyRelocatable = true;
+	//The shared delegate can be bound to a std::shared_ptr
+	static constexpr bool CanExpire = true;
+
+	SharedDelegate(DelegateT&& callback, bool isMutable)
+		: m_pBlock(CreateBlock(std::move(callback), isMutable))
+	{}
+
+	SharedDelegate(const SharedDelegate& other)
+		: m_pBlock(other.m_pBlock)
+	{
+		m_pBlock->RefCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	SharedDelegate& operator=(const SharedDelegate& other) = delete;
+
+	~SharedDelegate() noexcept
+	{
+		ReleaseBlock(m_pBlock);
+	}
+
+	virtual RetVal Execute(Args&&... args) override
+	{
+		return GetCallback().Execute(std::forward<Args>(args)...);
+	}
+
+	bool TryExecute(Args&&... args)
+	{
+		return GetCallback().ExecuteIfAlive(std::forward<Args>(args)...);
+	}
+
+	RetVal TryExecute(bool& isAlive, Args&&... args)
+	{
+		return GetCallback().ExecuteIfAlive(isAlive, std::forward<Args>(args)...);
+	}
+
+	virtual const void* GetOwner() const override
+	{
+		return m_pBlock->Callback.GetOwner();
+	}
+
+	virtual void Clone(void* pDestination) override
+	{
+		new (pDestination) SharedDelegate(*this);
+	}
+
+	virtual bool IsShared() const override
+	{
+		return true;
+	}
+
+	//True if no copy shares the delegate
+	bool IsUnique() const
+	{
+		return m_pBlock->RefCount.load(std::memory_order_acquire) == 1;
+	}
+
+	DelegateT& GetDelegate() const
+	{
+		return m_pBlock->Callback;
+	}
+
+	virtual bool IsMutable() const override
+	{
+		return m_pBlock->IsMutable;
+	}
+
+private:
+	struct Block
+	{
+		Block(DelegateT&& callback, bool isMutable)
+			: RefCount(1), IsMutable(isMutable), Callback(std::move(callback))
+		{}
+		std::atomic<unsigned int> RefCount;
+		const bool IsMutable;
+#if DELEGATE_PMR
+		//Resource the block came from, nullptr when it came from the allocation callbacks
+		std::pmr::memory_resource* pResource = nullptr;
+#endif
+		DelegateT Callback;
+	};
+
+	//With DELEGATE_PMR, the block comes from the memory resource of the current MemoryResourceScope like InlineAllocator
+	static Block* CreateBlock(DelegateT&& callback, bool isMutable)
+	{
+#if DELEGATE_PMR
+		std::pmr::memory_resource* pResource = _DelegatesInteral::CurrentMemoryResource();
+		if (pResource != nullptr)
+		{
+			Block* pBlock = new (pResource->allocate(sizeof(Block), alignof(Block))) Block(std::move(callback), isMutable);
+			pBlock->pResource = pResource;
+			return pBlock;
+		}
+#endif
+		return new (_DelegatesInteral::Alloc(sizeof(Block))) Block(std::move(callback), isMutable);
+	}
+
+	static void ReleaseBlock(Block* pBlock)
+	{
+		if (pBlock->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+#if DELEGATE_PMR
+			std::pmr::memory_resource* pResource = pBlock->pResource;
+			pBlock->~Block();
+			if (pResource != nullptr)
+			{
+				pResource->deallocate(pBlock, sizeof(Block), alignof(Block));
+			}
+			else
+#else
+			pBlock->~Block();
+#endif
+			{
+				_DelegatesInteral::Free(pBlock);
+			}
+		}
+	}
+
+	//Copy on write: a delegate that can change itself gets its own block if other copies share it.
+	//The copy comes from the same place as the block it was copied from.
+	DelegateT& GetCallback()
+	{
+		if (m_pBlock->IsMutable && IsUnique() == false)
+		{
+#if DELEGATE_PMR
+			_DelegatesInteral::MemoryResourceScope scope(m_pBlock->pResource);
+#endif
+			Block* pBlock = CreateBlock(DelegateT(m_pBlock->Callback), true);
+			ReleaseBlock(m_pBlock);
+			m_pBlock = pBlock;
+		}
+		return m_pBlock->Callback;
+	}
+
+	Block* m_pBlock;
+};
+
+//A handle to a delegate used for a multicast delegate
+//Static ID so that every handle is unique
+//The index is the slot of the delegate in the multicast delegate that created the handle.
+//Together with the unique ID (which acts as the generation of the slot) it allows
+//constant time lookups and detecting stale handles.
+class DelegateHandle
+{
+public:
+	constexpr DelegateHandle() noexcept
+		: m_Id(INVALID_ID), m_Index(INVALID_ID)
+	{
+	}
+
+	explicit DelegateHandle(bool /*generateId*/, unsigned int index = INVALID_ID) noexcept
+		: m_Id(GetNewID()), m_Index(index)
+	{
+	}
+
+	~DelegateHandle() noexcept = default;
+	DelegateHandle(const DelegateHandle& other) = default;
+	DelegateHandle& operator=(const DelegateHandle& other) = default;
+
+	DelegateHandle(DelegateHandle&& other) noexcept
+		: m_Id(other.m_Id), m_Index(other.m_Index)
 	{
 		other.Reset();
 	}
@@ -391,6 +1178,7 @@ public:
 	DelegateHandle& operator=(DelegateHandle&& other) noexcept
 	{
 		m_Id = other.m_Id;
+		m_Index = other.m_Index;
 		other.Reset();
 		return *this;
 	}
@@ -418,19 +1206,40 @@ public:
 	void Reset() noexcept
 	{
 		m_Id = INVALID_ID;
+		m_Index = INVALID_ID;
+	}
+
+	unsigned int GetIndex() const noexcept
+	{
+		return m_Index;
 	}
 
 	constexpr static const unsigned int INVALID_ID = (unsigned int)~0;
+
+	//Amount of IDs a thread reserves from the global counter at once
+	constexpr static const unsigned int ID_BLOCK_SIZE = 1024;
+
 private:
 	unsigned int m_Id;
-	static unsigned int CURRENT_ID;
+	unsigned int m_Index;
+	static std::atomic<unsigned int> CURRENT_ID;
 
-	static int GetNewID()
+	//Thread-safe. Every thread hands out IDs from its own block
+	//so the shared counter is only touched once every ID_BLOCK_SIZE handles.
+	static unsigned int GetNewID()
 	{
-		unsigned int output = DelegateHandle::CURRENT_ID++;
-		if (DelegateHandle::CURRENT_ID == INVALID_ID)
+		thread_local unsigned int nextId = 0;
+		thread_local unsigned int blockEnd = 0;
+		if (nextId == blockEnd)
+		{
+			nextId = DelegateHandle::CURRENT_ID.fetch_add(ID_BLOCK_SIZE, std::memory_order_relaxed);
+			blockEnd = nextId + ID_BLOCK_SIZE;
+		}
+		unsigned int output = nextId++;
+		//The counter wraps around, the last ID of the last block is reserved
+		if (output == INVALID_ID)
 		{
-			DelegateHandle::CURRENT_ID = 0;
+			return GetNewID();
 		}
 		return output;
 	}
@@ -482,7 +1291,7 @@ public:
 		other.m_Size = 0;
 		if (m_Size > MaxStackSize)
 		{
-			std::swap(pPtr, other.pPtr);
+			Heap = other.Heap;
 		}
 		else
 		{
@@ -498,7 +1307,7 @@ public:
 		other.m_Size = 0;
 		if (m_Size > MaxStackSize)
 		{
-			std::swap(pPtr, other.pPtr);
+			Heap = other.Heap;
 		}
 		else
 		{
@@ -509,6 +1318,7 @@ public:
 
 	//Allocate memory of given size
 	//If the size is over the predefined threshold, it will be allocated on the heap
+	//With DELEGATE_PMR, the heap allocation comes from the memory resource of the current MemoryResourceScope
 	void* Allocate(const size_t size)
 	{
 		if (m_Size != size)
@@ -517,11 +1327,18 @@ public:
 			m_Size = size;
 			if (size > MaxStackSize)
 			{
-				pPtr = _DelegatesInteral::Alloc(size);
-				return pPtr;
+#if DELEGATE_PMR
+				Heap.pResource = _DelegatesInteral::CurrentMemoryResource();
+				if (Heap.pResource != nullptr)
+				{
+					Heap.pPtr = Heap.pResource->allocate(size, alignof(std::max_align_t));
+					return Heap.pPtr;
+				}
+#endif
+				Heap.pPtr = _DelegatesInteral::Alloc(size);
 			}
 		}
-		return (void*)Buffer;
+		return GetAllocation();
 	}
 
 	//Free the allocated memory
@@ -529,7 +1346,16 @@ public:
 	{
 		if (m_Size > MaxStackSize)
 		{
-			_DelegatesInteral::Free(pPtr);
+#if DELEGATE_PMR
+			if (Heap.pResource != nullptr)
+			{
+				Heap.pResource->deallocate(Heap.pPtr, m_Size, alignof(std::max_align_t));
+			}
+			else
+#endif
+			{
+				_DelegatesInteral::Free(Heap.pPtr);
+			}
 		}
 		m_Size = 0;
 	}
@@ -539,7 +1365,7 @@ public:
 	{
 		if (HasAllocation())
 		{
-			return HasHeapAllocation() ? pPtr : (void*)Buffer;
+			return HasHeapAllocation() ? Heap.pPtr : (void*)Buffer;
 		}
 		else
 		{
@@ -563,32 +1389,52 @@ public:
 	}
 
 private:
+	struct HeapAllocation
+	{
+		void* pPtr;
+#if DELEGATE_PMR
+		//Resource the allocation came from, nullptr when it came from the allocation callbacks
+		std::pmr::memory_resource* pResource;
+#endif
+	};
+
+	static_assert(MaxStackSize >= sizeof(HeapAllocation), "MaxStackSize is too small to store a heap allocation");
+
 	//If the allocation is smaller than the threshold, Buffer is used
-	//Otherwise pPtr is used together with a separate dynamic allocation
+	//Otherwise Heap is used together with a separate dynamic allocation
 	union
 	{
 		char Buffer[MaxStackSize];
-		void* pPtr;
+		HeapAllocation Heap;
 	};
 	size_t m_Size;
 };
 
+//Base type for delegates that owns the bound delegate object
+//InlineSize is the size of the inline buffer, bigger delegates are heap allocated
+template<size_t InlineSize>
 class DelegateBase
 {
 public:
+	//Relocates a delegate that is not trivially relocatable into uninitialized memory and destroys the source
+	using RelocateFunction = void(*)(void* pDestination, void* pSource);
+
 	//Default constructor
 	constexpr DelegateBase() noexcept
-		: m_Allocator()
+		: m_Allocator(), m_pRelocate(nullptr)
 	{}
 
 	//Default destructor
-	virtual ~DelegateBase() noexcept
+	//Not virtual: delegates are never deleted through a DelegateBase pointer,
+	//so there is no need to pay for a vptr in every delegate.
+	~DelegateBase() noexcept
 	{
 		Release();
 	}
 
 	//Copy contructor
 	DelegateBase(const DelegateBase& other)
+		: m_Allocator(), m_pRelocate(other.m_pRelocate)
 	{
 		if (other.m_Allocator.HasAllocation())
 		{
@@ -601,6 +1447,7 @@ public:
 	DelegateBase& operator=(const DelegateBase& other)
 	{
 		Release();
+		m_pRelocate = other.m_pRelocate;
 		if (other.m_Allocator.HasAllocation())
 		{
 			m_Allocator.Allocate(other.m_Allocator.GetSize());
@@ -611,14 +1458,19 @@ public:
 
 	//Move constructor
 	DelegateBase(DelegateBase&& other) noexcept
-		: m_Allocator(std::move(other.m_Allocator))
-	{}
+		: m_Allocator(), m_pRelocate(nullptr)
+	{
+		MoveFrom(other);
+	}
 
 	//Move assignment operator
 	DelegateBase& operator=(DelegateBase&& other) noexcept
 	{
-		Release();
-		m_Allocator = std::move(other.m_Allocator);
+		if (this != &other)
+		{
+			Release();
+			MoveFrom(other);
+		}
 		return *this;
 	}
 
@@ -685,17 +1537,66 @@ protected:
 		return static_cast<IDelegateBase*>(m_Allocator.GetAllocation());
 	}
 
+	//Take over the delegate of other, leaving other unbound.
+	//Heap allocations are handed over and trivially relocatable delegates are memcpy'd by the allocator.
+	//Anything else is move constructed into the inline buffer.
+	void MoveFrom(DelegateBase& other) noexcept
+	{
+		m_pRelocate = other.m_pRelocate;
+		if (other.m_Allocator.HasAllocation())
+		{
+			if (m_pRelocate == nullptr || other.m_Allocator.HasHeapAllocation())
+			{
+				m_Allocator = std::move(other.m_Allocator);
+			}
+			else
+			{
+				m_pRelocate(m_Allocator.Allocate(other.m_Allocator.GetSize()), other.m_Allocator.GetAllocation());
+				other.m_Allocator.Free();
+			}
+		}
+	}
+
+	template<typename T>
+	static RelocateFunction GetRelocateFunction()
+	{
+		return T::IsTriviallyRelocatable ? nullptr : &Relocate<T>;
+	}
+
+	template<typename T>
+	static void Relocate(void* pDestination, void* pSource)
+	{
+		T* pObject = static_cast<T*>(pSource);
+		new (pDestination) T(std::move(*pObject));
+		pObject->~T();
+	}
+
 	//Allocator for the delegate itself.
-	//Delegate gets allocated when its is smaller or equal than 64 bytes in size.
-	//Can be changed by preference
-	InlineAllocator<DELEGATE_INLINE_ALLOCATION_SIZE> m_Allocator;
+	//Delegate gets allocated inline when it is smaller or equal than InlineSize bytes in size.
+	InlineAllocator<InlineSize> m_Allocator;
+
+	//nullptr if the bound delegate can be moved with a memcpy
+	RelocateFunction m_pRelocate;
 };
 
+template<typename RetVal>
+class DelegateFuture;
+
+template<size_t InlineSize, typename RetVal, typename... Args>
+class AsyncDelegateCall;
+
 //Delegate that can be bound to by just ONE object
-template<typename RetVal, typename... Args>
-class Delegate : public DelegateBase
+//Delegates up to InlineSize bytes are stored inline, bigger ones are heap allocated.
+//Use the Delegate alias for the default size (DELEGATE_INLINE_ALLOCATION_SIZE)
+template<size_t InlineSize, typename RetVal, typename... Args>
+class InlineDelegate : public DelegateBase<InlineSize>
 {
 private:
+	using Base = DelegateBase<InlineSize>;
+	using Base::m_Allocator;
+	using Base::m_pRelocate;
+	using Base::Release;
+
 	template<typename T, typename... Args2>
 	using ConstMemberFunction = typename _DelegatesInteral::MemberFunction<true, T, RetVal, Args..., Args2...>::Type;
 	template<typename T, typename... Args2>
@@ -704,59 +1605,98 @@ private:
 public:
 	using IDelegateT = IDelegate<RetVal, Args...>;
 
+	//Type-erased entry point into the bound delegate.
+	//Stored next to the allocation so Execute is a single indirect call
+	//instead of loading the vptr of the bound object first.
+	//Without a return value, it returns whether the bound object was still alive instead.
+	//With a return value, it sets isAlive to false if the bound object expired.
+	using InvokerFunction = typename std::conditional<std::is_void<RetVal>::value,
+		bool(*)(void* pDelegate, Args&&... args),
+		RetVal(*)(void* pDelegate, bool& isAlive, Args&&... args)>::type;
+
 	//Create delegate using member function
 	template<typename T, typename... Args2>
-	NO_DISCARD static Delegate CreateRaw(T* pObj, NonConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	NO_DISCARD static InlineDelegate CreateRaw(T* pObj, NonConstMemberFunction<T, Args2...> pFunction, Args2... args)
 	{
-		Delegate handler;
+		InlineDelegate handler;
 		handler.Bind<RawDelegate<false, T, RetVal(Args...), Args2...>>(pObj, pFunction, std::forward<Args2>(args)...);
 		return handler;
 	}
 
 	template<typename T, typename... Args2>
-	NO_DISCARD static Delegate CreateRaw(T* pObj, ConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	NO_DISCARD static InlineDelegate CreateRaw(T* pObj, ConstMemberFunction<T, Args2...> pFunction, Args2... args)
 	{
-		Delegate handler;
+		InlineDelegate handler;
 		handler.Bind<RawDelegate<true, T, RetVal(Args...), Args2...>>(pObj, pFunction, std::forward<Args2>(args)...);
 		return handler;
 	}
 
 	//Create delegate using global/static function
 	template<typename... Args2>
-	NO_DISCARD static Delegate CreateStatic(RetVal(*pFunction)(Args..., Args2...), Args2... args)
+	NO_DISCARD static InlineDelegate CreateStatic(RetVal(*pFunction)(Args..., Args2...), Args2... args)
 	{
-		Delegate handler;
+		InlineDelegate handler;
 		handler.Bind<StaticDelegate<RetVal(Args...), Args2...>>(pFunction, std::forward<Args2>(args)...);
 		return handler;
 	}
 
 	//Create delegate using std::shared_ptr
 	template<typename T, typename... Args2>
-	NO_DISCARD static Delegate CreateSP(const std::shared_ptr<T>& pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	NO_DISCARD static InlineDelegate CreateSP(const std::shared_ptr<T>& pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2... args)
 	{
-		Delegate handler;
+		InlineDelegate handler;
 		handler.Bind<SPDelegate<false, T, RetVal(Args...), Args2...>>(pObject, pFunction, std::forward<Args2>(args)...);
 		return handler;
 	}
 
 	template<typename T, typename... Args2>
-	NO_DISCARD static Delegate CreateSP(const std::shared_ptr<T>& pObject, ConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	NO_DISCARD static InlineDelegate CreateSP(const std::shared_ptr<T>& pObject, ConstMemberFunction<T, Args2...> pFunction, Args2... args)
 	{
-		Delegate handler;
+		InlineDelegate handler;
 		handler.Bind<SPDelegate<true, T, RetVal(Args...), Args2...>>(pObject, pFunction, std::forward<Args2>(args)...);
 		return handler;
 	}
 
 	//Create delegate using a lambda
 	template<typename TLambda, typename... Args2>
-	NO_DISCARD static Delegate CreateLambda(TLambda&& lambda, Args2... args)
+	NO_DISCARD static InlineDelegate CreateLambda(TLambda&& lambda, Args2... args)
 	{
-		Delegate handler;
+		InlineDelegate handler;
 		using LambdaType = std::decay_t<TLambda>;
 		handler.Bind<LambdaDelegate<LambdaType, RetVal(Args...), Args2...>>(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...);
 		return handler;
 	}
 
+	//Create delegate with a global/static function that is known at compile time
+	//The call is direct and only the payload is stored
+	//Delegate<int, float>::Create<decltype(&Function), &Function>(); or Create<&Function>() in C++17
+	template<typename FunctionT, FunctionT Function, typename... Args2, typename std::enable_if<!std::is_member_function_pointer<FunctionT>::value, int>::type = 0>
+	NO_DISCARD static InlineDelegate Create(Args2... args)
+	{
+		InlineDelegate handler;
+		handler.Bind<DirectStaticDelegate<FunctionT, Function, RetVal(Args...), Args2...>>(std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	//Create delegate with a member function that is known at compile time
+	//The call is direct and only the object pointer and payload are stored
+	//Delegate<int, float>::Create<decltype(&Foo::Bar), &Foo::Bar>(&foo); or Create<&Foo::Bar>(&foo) in C++17
+	template<typename FunctionT, FunctionT Function, typename T, typename... Args2, typename std::enable_if<std::is_member_function_pointer<FunctionT>::value, int>::type = 0>
+	NO_DISCARD static InlineDelegate Create(T* pObject, Args2... args)
+	{
+		InlineDelegate handler;
+		handler.Bind<DirectRawDelegate<T, FunctionT, Function, RetVal(Args...), Args2...>>(pObject, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+#if DELEGATE_AUTO_TEMPLATE
+	template<auto Function, typename... Args2>
+	NO_DISCARD static InlineDelegate Create(Args2&&... args)
+	{
+		return Create<decltype(Function), Function>(std::forward<Args2>(args)...);
+	}
+#endif
+
 	//Bind a member function
 	template<typename T, typename... Args2>
 	void BindRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
@@ -803,138 +1743,2520 @@ public:
 	RetVal Execute(Args... args) const
 	{
 		DELEGATE_ASSERT(m_Allocator.HasAllocation(), "Delegate is not bound");
-		return ((IDelegateT*)GetDelegate())->Execute(std::forward<Args>(args)...);
+		return ExecuteImpl(std::is_void<RetVal>(), std::forward<Args>(args)...);
 	}
 
 	RetVal ExecuteIfBound(Args... args) const
 	{
-		if (IsBound())
+		if (this->IsBound())
 		{
-			return ((IDelegateT*)GetDelegate())->Execute(std::forward<Args>(args)...);
+			return ExecuteImpl(std::is_void<RetVal>(), std::forward<Args>(args)...);
 		}
 		return RetVal();
 	}
 
-private:
-	template<typename T, typename... Args3>
-	void Bind(Args3&&... args)
+	//Execute the delegate with the given parameters
+	//Returns false if the delegate is bound to a std::shared_ptr that expired
+	//Only available for delegates without a return value
+	template<typename R = RetVal, typename std::enable_if<std::is_void<R>::value, int>::type = 0>
+	bool ExecuteIfAlive(Args... args) const
 	{
-		Release();
-		void* pAlloc = m_Allocator.Allocate(sizeof(T));
-		new (pAlloc) T(std::forward<Args3>(args)...);
+		DELEGATE_ASSERT(m_Allocator.HasAllocation(), "Delegate is not bound");
+		return m_pInvoker(m_Allocator.GetAllocation(), std::forward<Args>(args)...);
 	}
-};
-
-//Delegate that can be bound to by MULTIPLE objects
-template<typename... Args>
-class MulticastDelegate : public DelegateBase
-{
-public:
-	using DelegateT = Delegate<void, Args...>;
 
-private:
-	struct DelegateHandlerPair
+	//Execute the delegate with the given parameters
+	//Sets isAlive to false and returns a default constructed value if the delegate is bound to a std::shared_ptr that expired
+	//Only available for delegates with a return value
+	template<typename R = RetVal, typename std::enable_if<!std::is_void<R>::value, int>::type = 0>
+	RetVal ExecuteIfAlive(bool& isAlive, Args... args) const
 	{
-		DelegateHandle Handle;
-		DelegateT Callback;
-		DelegateHandlerPair() : Handle(false) {}
-		DelegateHandlerPair(const DelegateHandle& handle, const DelegateT& callback) : Handle(handle), Callback(callback) {}
-		DelegateHandlerPair(const DelegateHandle& handle, DelegateT&& callback) : Handle(handle), Callback(std::move(callback)) {}
-	};
-	template<typename T, typename... Args2>
-	using ConstMemberFunction = typename _DelegatesInteral::MemberFunction<true, T, void, Args..., Args2...>::Type;
-	template<typename T, typename... Args2>
-	using NonConstMemberFunction = typename _DelegatesInteral::MemberFunction<false, T, void, Args..., Args2...>::Type;
+		DELEGATE_ASSERT(m_Allocator.HasAllocation(), "Delegate is not bound");
+		isAlive = true;
+		return m_pInvoker(m_Allocator.GetAllocation(), isAlive, std::forward<Args>(args)...);
+	}
 
-public:
-	//Default constructor
-	constexpr MulticastDelegate()
-		: m_Locks(0)
+	//Move the bound delegate into a reference counted allocation that is shared by all copies from then on
+	//Copying a shared delegate never allocates, which is useful to hand a delegate with a large closure to many consumers.
+	//Only a delegate that can't change itself is shared when executed. A mutable lambda, or a lambda that takes its payload
+	//by non-const reference, is copied first by a copy that executes it while other copies share it (copy on write).
+	//With DELEGATE_PMR, the allocation comes from the memory resource of the current MemoryResourceScope.
+	void Share()
 	{
+		if (this->IsBound() && IsShared() == false)
+		{
+			const bool isMutable = this->GetDelegate()->IsMutable();
+			InlineDelegate callback(std::move(*this));
+			Bind<SharedDelegate<InlineDelegate, RetVal, Args...>>(std::move(callback), isMutable);
+		}
 	}
 
-	//Default destructor
-	~MulticastDelegate() noexcept = default;
-
-	//Default copy constructor
-	MulticastDelegate(const MulticastDelegate& other) = default;
-
-	//Defaul copy assignment operator
-	MulticastDelegate& operator=(const MulticastDelegate& other) = default;
-
-	//Move constructor
-	MulticastDelegate(MulticastDelegate&& other) noexcept
-		: m_Events(std::move(other.m_Events)),
-		m_Locks(std::move(other.m_Locks))
+	bool IsShared() const
 	{
+		return this->IsBound() && this->GetDelegate()->IsShared();
 	}
 
-	//Move assignment operator
-	MulticastDelegate& operator=(MulticastDelegate&& other) noexcept
+	//Give a shared delegate its own copy of the bound delegate if other copies share it
+	//The delegate stays shared, so copies of it share the new copy.
+	//Happens on its own before executing a delegate that can change itself.
+	void MakeUnique()
 	{
-		m_Events = std::move(other.m_Events);
-		m_Locks = std::move(other.m_Locks);
-		return *this;
+		if (IsShared())
+		{
+			using SharedT = SharedDelegate<InlineDelegate, RetVal, Args...>;
+			SharedT* pShared = static_cast<SharedT*>(this->GetDelegate());
+			if (pShared->IsUnique() == false)
+			{
+				InlineDelegate callback(pShared->GetDelegate());
+				Bind<SharedT>(std::move(callback), pShared->IsMutable());
+			}
+		}
 	}
 
-	template<typename T>
-	DelegateHandle operator+=(T&& l)
+	//Execute a copy of the delegate on the executor without waiting for it
+	//The arguments are copied as well. The future gives access to the result.
+	DelegateFuture<RetVal> ExecuteOn(Delegates::IExecutor& executor, Args... args) const
 	{
-		return Add(DelegateT::CreateLambda(std::move(l)));
+		DELEGATE_ASSERT(m_Allocator.HasAllocation(), "Delegate is not bound");
+		using CallT = AsyncDelegateCall<InlineSize, RetVal, Args...>;
+		CallT* pCall = CallT::Create(*this, std::forward<Args>(args)...);
+		DelegateFuture<RetVal> future(pCall);
+		executor.Post(&CallT::Execute, pCall);
+		return future;
 	}
 
-	//Add delegate with the += operator
-	DelegateHandle operator+=(DelegateT&& handler) noexcept
+	//Execute a copy of the delegate on the default executor
+	DelegateFuture<RetVal> ExecuteAsync(Args... args) const
 	{
-		return Add(std::forward<DelegateT>(handler));
+		return ExecuteOn(Delegates::WorkStealingExecutor::GetDefault(), std::forward<Args>(args)...);
 	}
 
-	//Remove a delegate using its DelegateHandle
-	bool operator-=(DelegateHandle& handle)
+private:
+	//Reads the invoker and the allocation directly to build its listener records
+	template<size_t, typename, typename...>
+	friend class MulticastDelegateBase;
+	//Binds batch delegates
+	template<size_t, typename...>
+	friend class InlineMulticastDelegate;
+
+	template<typename T, typename... Args3>
+	void Bind(Args3&&... args)
 	{
-		return Remove(handle);
+		Release();
+		void* pAlloc = m_Allocator.Allocate(sizeof(T));
+		new (pAlloc) T(std::forward<Args3>(args)...);
+		m_pInvoker = GetInvoker<T>(std::is_void<RetVal>());
+		m_pRelocate = Base::template GetRelocateFunction<T>();
 	}
 
-	DelegateHandle Add(DelegateT&& handler) noexcept
+	//Without return value
+	RetVal ExecuteImpl(std::true_type, Args&&... args) const
 	{
-		//Favour an empty space over a possible array reallocation
-		for (size_t i = 0; i < m_Events.size(); ++i)
-		{
-			if (m_Events[i].Handle.IsValid() == false)
-			{
-				m_Events[i] = DelegateHandlerPair(DelegateHandle(true), std::move(handler));
-				return m_Events[i].Handle;
-			}
-		}
-		m_Events.emplace_back(DelegateHandle(true), std::move(handler));
-		return m_Events.back().Handle;
+		m_pInvoker(m_Allocator.GetAllocation(), std::forward<Args>(args)...);
 	}
 
-	//Bind a member function
-	template<typename T, typename... Args2>
-	DelegateHandle AddRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	//With return value, an expired object returns a default constructed value
+	RetVal ExecuteImpl(std::false_type, Args&&... args) const
 	{
-		return Add(DelegateT::CreateRaw(pObject, pFunction, std::forward<Args2>(args)...));
+		bool isAlive = true;
+		return m_pInvoker(m_Allocator.GetAllocation(), isAlive, std::forward<Args>(args)...);
 	}
 
-	template<typename T, typename... Args2>
-	DelegateHandle AddRaw(T* pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	template<typename T>
+	static InvokerFunction GetInvoker(std::true_type)
 	{
-		return Add(DelegateT::CreateRaw(pObject, pFunction, std::forward<Args2>(args)...));
+		return &Invoke<T>;
 	}
 
-	//Bind a static/global function
-	template<typename... Args2>
-	DelegateHandle AddStatic(void(*pFunction)(Args..., Args2...), Args2&&... args)
+	template<typename T>
+	static InvokerFunction GetInvoker(std::false_type)
 	{
-		return Add(DelegateT::CreateStatic(pFunction, std::forward<Args2>(args)...));
+		return &InvokeWithResult<T>;
 	}
 
-	//Bind a lambda
-	template<typename LambdaType, typename... Args2>
-	DelegateHandle AddLambda(LambdaType&& lambda, Args2&&... args)
+	//Qualified call so the compiler can call (and inline) T::Execute directly
+	template<typename T>
+	static bool Invoke(void* pDelegate, Args&&... args)
 	{
-		return Add(DelegateT::CreateLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...));
+		return InvokeImpl(std::integral_constant<bool, T::CanExpire>(), static_cast<T*>(pDelegate), std::forward<Args>(args)...);
+	}
+
+	template<typename T>
+	static RetVal InvokeWithResult(void* pDelegate, bool& isAlive, Args&&... args)
+	{
+		return InvokeWithResultImpl(std::integral_constant<bool, T::CanExpire>(), static_cast<T*>(pDelegate), isAlive, std::forward<Args>(args)...);
+	}
+
+	//Without return value, the object is always alive
+	template<typename T>
+	static bool InvokeImpl(std::false_type, T* pDelegate, Args&&... args)
+	{
+		pDelegate->T::Execute(std::forward<Args>(args)...);
+		return true;
+	}
+
+	//Without return value, the object might have expired
+	template<typename T>
+	static bool InvokeImpl(std::true_type, T* pDelegate, Args&&... args)
+	{
+		return pDelegate->T::TryExecute(std::forward<Args>(args)...);
+	}
+
+	//With return value, the object is always alive
+	template<typename T>
+	static RetVal InvokeWithResultImpl(std::false_type, T* pDelegate, bool&, Args&&... args)
+	{
+		return pDelegate->T::Execute(std::forward<Args>(args)...);
+	}
+
+	//With return value, the object might have expired. Locked once for both the check and the call.
+	template<typename T>
+	static RetVal InvokeWithResultImpl(std::true_type, T* pDelegate, bool& isAlive, Args&&... args)
+	{
+		return pDelegate->T::TryExecute(isAlive, std::forward<Args>(args)...);
+	}
+
+	//Only meaningful while the allocator holds a delegate
+	InvokerFunction m_pInvoker = nullptr;
+};
+
+template<typename RetVal, typename... Args>
+using Delegate = InlineDelegate<DELEGATE_INLINE_ALLOCATION_SIZE, RetVal, Args...>;
+
+namespace _DelegatesInteral
+{
+	//Callables bound by a CompactDelegate
+	//Unlike the IDelegate types they have no vptr, the compact delegate keeps its own type-erased functions.
+	//The payload is a base so it takes no space when there is none.
+
+	template<typename FunctionT, typename... Args2>
+	struct StaticCall : private std::tuple<Args2...>
+	{
+		StaticCall(FunctionT function, Args2&&... payload)
+			: std::tuple<Args2...>(std::forward<Args2>(payload)...), Function(function)
+		{}
+
+		template<typename... Args>
+		decltype(auto) operator()(Args&&... args)
+		{
+			return Call(std::index_sequence_for<Args2...>(), std::forward<Args>(args)...);
+		}
+
+		template<size_t... Is, typename... Args>
+		decltype(auto) Call(std::index_sequence<Is...>, Args&&... args)
+		{
+			return Function(std::forward<Args>(args)..., std::get<Is>(static_cast<std::tuple<Args2...>&>(*this))...);
+		}
+
+		FunctionT Function;
+	};
+
+	template<typename FunctionT, FunctionT Function, typename... Args2>
+	struct DirectStaticCall : private std::tuple<Args2...>
+	{
+		DirectStaticCall(Args2&&... payload)
+			: std::tuple<Args2...>(std::forward<Args2>(payload)...)
+		{}
+
+		template<typename... Args>
+		decltype(auto) operator()(Args&&... args)
+		{
+			return Call(std::index_sequence_for<Args2...>(), std::forward<Args>(args)...);
+		}
+
+		template<size_t... Is, typename... Args>
+		decltype(auto) Call(std::index_sequence<Is...>, Args&&... args)
+		{
+			return Function(std::forward<Args>(args)..., std::get<Is>(static_cast<std::tuple<Args2...>&>(*this))...);
+		}
+	};
+
+	template<typename T, typename FunctionT, typename... Args2>
+	struct RawCall : private std::tuple<Args2...>
+	{
+		RawCall(T* pObj, FunctionT function, Args2&&... payload)
+			: std::tuple<Args2...>(std::forward<Args2>(payload)...), pObject(pObj), Function(function)
+		{}
+
+		template<typename... Args>
+		decltype(auto) operator()(Args&&... args)
+		{
+			return Call(std::index_sequence_for<Args2...>(), std::forward<Args>(args)...);
+		}
+
+		template<size_t... Is, typename... Args>
+		decltype(auto) Call(std::index_sequence<Is...>, Args&&... args)
+		{
+			return (pObject->*Function)(std::forward<Args>(args)..., std::get<Is>(static_cast<std::tuple<Args2...>&>(*this))...);
+		}
+
+		const void* GetOwner() const
+		{
+			return pObject;
+		}
+
+		T* pObject;
+		FunctionT Function;
+	};
+
+	template<typename T, typename FunctionT, FunctionT Function, typename... Args2>
+	struct DirectRawCall : private std::tuple<Args2...>
+	{
+		DirectRawCall(T* pObj, Args2&&... payload)
+			: std::tuple<Args2...>(std::forward<Args2>(payload)...), pObject(pObj)
+		{}
+
+		template<typename... Args>
+		decltype(auto) operator()(Args&&... args)
+		{
+			return Call(std::index_sequence_for<Args2...>(), std::forward<Args>(args)...);
+		}
+
+		template<size_t... Is, typename... Args>
+		decltype(auto) Call(std::index_sequence<Is...>, Args&&... args)
+		{
+			return (pObject->*Function)(std::forward<Args>(args)..., std::get<Is>(static_cast<std::tuple<Args2...>&>(*this))...);
+		}
+
+		const void* GetOwner() const
+		{
+			return pObject;
+		}
+
+		T* pObject;
+	};
+
+	//Returns a default constructed value when the object expired
+	template<typename RetVal, typename T, typename FunctionT, typename... Args2>
+	struct SPCall : private std::tuple<Args2...>
+	{
+		SPCall(const std::shared_ptr<T>& pObj, FunctionT function, Args2&&... payload)
+			: std::tuple<Args2...>(std::forward<Args2>(payload)...), pObject(pObj), Function(function)
+		{}
+
+		template<typename... Args>
+		RetVal operator()(Args&&... args)
+		{
+			std::shared_ptr<T> pPinned = pObject.lock();
+			if (pPinned == nullptr)
+			{
+				return RetVal();
+			}
+			return Call(pPinned.get(), std::index_sequence_for<Args2...>(), std::forward<Args>(args)...);
+		}
+
+		template<size_t... Is, typename... Args>
+		RetVal Call(T* pPinned, std::index_sequence<Is...>, Args&&... args)
+		{
+			return (pPinned->*Function)(std::forward<Args>(args)..., std::get<Is>(static_cast<std::tuple<Args2...>&>(*this))...);
+		}
+
+		const void* GetOwner() const
+		{
+			return pObject.lock().get();
+		}
+
+		std::weak_ptr<T> pObject;
+		FunctionT Function;
+	};
+
+	template<typename TLambda, typename... Args2>
+	struct LambdaCall : private std::tuple<Args2...>
+	{
+		template<typename TLambda2>
+		LambdaCall(TLambda2&& lambda, Args2&&... payload)
+			: std::tuple<Args2...>(std::forward<Args2>(payload)...), Lambda(std::forward<TLambda2>(lambda))
+		{}
+
+		template<typename... Args>
+		decltype(auto) operator()(Args&&... args)
+		{
+			return Call(std::index_sequence_for<Args2...>(), std::forward<Args>(args)...);
+		}
+
+		template<size_t... Is, typename... Args>
+		decltype(auto) Call(std::index_sequence<Is...>, Args&&... args)
+		{
+			return Lambda(std::forward<Args>(args)..., std::get<Is>(static_cast<std::tuple<Args2...>&>(*this))...);
+		}
+
+		TLambda Lambda;
+	};
+
+	//Calls GetOwner() if the callable has one
+	template<typename T>
+	auto GetCallOwner(const T& call, int) -> decltype(call.GetOwner())
+	{
+		return call.GetOwner();
+	}
+
+	template<typename T>
+	const void* GetCallOwner(const T&, long)
+	{
+		return nullptr;
+	}
+}
+
+//Delegate with a smaller footprint for when there are a lot of them, eg. in component arrays
+//It's an invoker, a manager and StorageSize bytes of inline storage. The manager is a function per bound type
+//that copies, moves and destroys the callable, so the delegate doesn't store a size or vptr and the callables have no vptr either.
+//Bound callables larger than StorageSize are heap allocated with the allocation callbacks.
+//Use the CompactDelegate alias for a single pointer of storage (24 bytes on 64-bit):
+//enough for a global function, a lambda capturing a pointer or Create<&Foo::Bar>(&foo) inline.
+template<size_t StorageSize, typename RetVal, typename... Args>
+class InlineCompactDelegate
+{
+private:
+	template<typename T, typename... Args2>
+	using ConstMemberFunction = typename _DelegatesInteral::MemberFunction<true, T, RetVal, Args..., Args2...>::Type;
+	template<typename T, typename... Args2>
+	using NonConstMemberFunction = typename _DelegatesInteral::MemberFunction<false, T, RetVal, Args..., Args2...>::Type;
+
+	enum class Operation
+	{
+		Clone,
+		Move,
+		Destroy,
+		GetOwner,
+	};
+
+	using InvokerFunction = RetVal(*)(void* pStorage, Args&&... args);
+	//Clone/Move from the source storage into the destination storage, Destroy or GetOwner of the source storage
+	using ManagerFunction = const void*(*)(Operation operation, void* pDestination, void* pSource);
+
+	static_assert(StorageSize >= sizeof(void*), "The storage must be able to hold a heap allocation");
+
+public:
+	constexpr InlineCompactDelegate() noexcept
+		: m_pInvoker(nullptr), m_pManager(nullptr), m_Storage()
+	{}
+
+	~InlineCompactDelegate() noexcept
+	{
+		Clear();
+	}
+
+	InlineCompactDelegate(const InlineCompactDelegate& other)
+		: m_pInvoker(other.m_pInvoker), m_pManager(other.m_pManager)
+	{
+		if (m_pManager != nullptr)
+		{
+			m_pManager(Operation::Clone, m_Storage, other.GetStorage());
+		}
+	}
+
+	InlineCompactDelegate& operator=(const InlineCompactDelegate& other)
+	{
+		if (this != &other)
+		{
+			Clear();
+			if (other.m_pManager != nullptr)
+			{
+				other.m_pManager(Operation::Clone, m_Storage, other.GetStorage());
+				m_pInvoker = other.m_pInvoker;
+				m_pManager = other.m_pManager;
+			}
+		}
+		return *this;
+	}
+
+	InlineCompactDelegate(InlineCompactDelegate&& other) noexcept
+		: m_pInvoker(nullptr), m_pManager(nullptr)
+	{
+		MoveFrom(other);
+	}
+
+	InlineCompactDelegate& operator=(InlineCompactDelegate&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Clear();
+			MoveFrom(other);
+		}
+		return *this;
+	}
+
+	//Create delegate using member function
+	template<typename T, typename... Args2>
+	NO_DISCARD static InlineCompactDelegate CreateRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::RawCall<T, NonConstMemberFunction<T, Args2...>, Args2...>>(pObject, pFunction, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	template<typename T, typename... Args2>
+	NO_DISCARD static InlineCompactDelegate CreateRaw(T* pObject, ConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::RawCall<T, ConstMemberFunction<T, Args2...>, Args2...>>(pObject, pFunction, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	//Create delegate using global/static function
+	template<typename... Args2>
+	NO_DISCARD static InlineCompactDelegate CreateStatic(RetVal(*pFunction)(Args..., Args2...), Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::StaticCall<RetVal(*)(Args..., Args2...), Args2...>>(pFunction, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	//Create delegate using std::shared_ptr
+	template<typename T, typename... Args2>
+	NO_DISCARD static InlineCompactDelegate CreateSP(const std::shared_ptr<T>& pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::SPCall<RetVal, T, NonConstMemberFunction<T, Args2...>, Args2...>>(pObject, pFunction, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	template<typename T, typename... Args2>
+	NO_DISCARD static InlineCompactDelegate CreateSP(const std::shared_ptr<T>& pObject, ConstMemberFunction<T, Args2...> pFunction, Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::SPCall<RetVal, T, ConstMemberFunction<T, Args2...>, Args2...>>(pObject, pFunction, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	//Create delegate using a lambda
+	template<typename TLambda, typename... Args2>
+	NO_DISCARD static InlineCompactDelegate CreateLambda(TLambda&& lambda, Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::LambdaCall<std::decay_t<TLambda>, Args2...>>(std::forward<TLambda>(lambda), std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	//Create delegate with a global/static function that is known at compile time, see InlineDelegate::Create
+	template<typename FunctionT, FunctionT Function, typename... Args2, typename std::enable_if<!std::is_member_function_pointer<FunctionT>::value, int>::type = 0>
+	NO_DISCARD static InlineCompactDelegate Create(Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::DirectStaticCall<FunctionT, Function, Args2...>>(std::forward<Args2>(args)...);
+		return handler;
+	}
+
+	//Create delegate with a member function that is known at compile time, see InlineDelegate::Create
+	template<typename FunctionT, FunctionT Function, typename T, typename... Args2, typename std::enable_if<std::is_member_function_pointer<FunctionT>::value, int>::type = 0>
+	NO_DISCARD static InlineCompactDelegate Create(T* pObject, Args2... args)
+	{
+		InlineCompactDelegate handler;
+		handler.Bind<_DelegatesInteral::DirectRawCall<T, FunctionT, Function, Args2...>>(pObject, std::forward<Args2>(args)...);
+		return handler;
+	}
+
+#if DELEGATE_AUTO_TEMPLATE
+	template<auto Function, typename... Args2>
+	NO_DISCARD static InlineCompactDelegate Create(Args2&&... args)
+	{
+		return Create<decltype(Function), Function>(std::forward<Args2>(args)...);
+	}
+#endif
+
+	//Bind a member function
+	template<typename T, typename... Args2>
+	void BindRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		DELEGATE_STATIC_ASSERT(!std::is_const<T>::value, "Cannot bind a non-const function on a const object");
+		*this = CreateRaw<T, Args2... >(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	template<typename T, typename... Args2>
+	void BindRaw(T* pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		*this = CreateRaw<T, Args2... >(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	//Bind a static/global function
+	template<typename... Args2>
+	void BindStatic(RetVal(*pFunction)(Args..., Args2...), Args2&&... args)
+	{
+		*this = CreateStatic<Args2... >(pFunction, std::forward<Args2>(args)...);
+	}
+
+	//Bind a lambda
+	template<typename LambdaType, typename... Args2>
+	void BindLambda(LambdaType&& lambda, Args2&&... args)
+	{
+		*this = CreateLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...);
+	}
+
+	//Bind a member function with a shared_ptr object
+	template<typename T, typename... Args2>
+	void BindSP(std::shared_ptr<T> pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		*this = CreateSP<T, Args2... >(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	template<typename T, typename... Args2>
+	void BindSP(std::shared_ptr<T> pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		*this = CreateSP<T, Args2... >(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	//Execute the delegate with the given parameters
+	RetVal Execute(Args... args) const
+	{
+		DELEGATE_ASSERT(m_pInvoker != nullptr, "Delegate is not bound");
+		return m_pInvoker(GetStorage(), std::forward<Args>(args)...);
+	}
+
+	RetVal ExecuteIfBound(Args... args) const
+	{
+		if (IsBound())
+		{
+			return m_pInvoker(GetStorage(), std::forward<Args>(args)...);
+		}
+		return RetVal();
+	}
+
+	//Gets the owner of the delegate
+	//Only valid for raw and shared_ptr bindings, otherwise nullptr
+	const void* GetOwner() const
+	{
+		return m_pManager != nullptr ? m_pManager(Operation::GetOwner, nullptr, GetStorage()) : nullptr;
+	}
+
+	bool IsBound() const
+	{
+		return m_pInvoker != nullptr;
+	}
+
+	bool IsBoundTo(void* pObject) const
+	{
+		return pObject != nullptr && GetOwner() == pObject;
+	}
+
+	//Clear the bound delegate if it is bound to the given object.
+	//Ignored when pObject is a nullptr
+	void ClearIfBoundTo(void* pObject)
+	{
+		if (IsBoundTo(pObject))
+		{
+			Clear();
+		}
+	}
+
+	void Clear()
+	{
+		if (m_pManager != nullptr)
+		{
+			m_pManager(Operation::Destroy, nullptr, m_Storage);
+			m_pInvoker = nullptr;
+			m_pManager = nullptr;
+		}
+	}
+
+private:
+	//Callables that don't fit or can't be moved safely are heap allocated and the storage holds the pointer
+	template<typename T>
+	using IsInline = std::integral_constant<bool, sizeof(T) <= StorageSize && alignof(T) <= alignof(void*) && std::is_nothrow_move_constructible<T>::value>;
+
+	template<typename T, typename... Args2>
+	void Bind(Args2&&... args)
+	{
+		Clear();
+		new (Allocate<T>(IsInline<T>())) T(std::forward<Args2>(args)...);
+		m_pInvoker = &Invoke<T>;
+		m_pManager = &Manage<T>;
+	}
+
+	template<typename T>
+	void* Allocate(std::true_type)
+	{
+		return m_Storage;
+	}
+
+	template<typename T>
+	void* Allocate(std::false_type)
+	{
+		void* pMemory = _DelegatesInteral::Alloc(sizeof(T));
+		*reinterpret_cast<void**>(m_Storage) = pMemory;
+		return pMemory;
+	}
+
+	template<typename T>
+	static T* GetCall(void* pStorage, std::true_type)
+	{
+		return static_cast<T*>(pStorage);
+	}
+
+	template<typename T>
+	static T* GetCall(void* pStorage, std::false_type)
+	{
+		return *static_cast<T**>(pStorage);
+	}
+
+	template<typename T>
+	static RetVal Invoke(void* pStorage, Args&&... args)
+	{
+		return static_cast<RetVal>((*GetCall<T>(pStorage, IsInline<T>()))(std::forward<Args>(args)...));
+	}
+
+	template<typename T>
+	static const void* Manage(Operation operation, void* pDestination, void* pSource)
+	{
+		T* pCall = GetCall<T>(pSource, IsInline<T>());
+		switch (operation)
+		{
+		case Operation::Clone:
+			Clone<T>(pDestination, *pCall, IsInline<T>());
+			break;
+		case Operation::Move:
+			Move<T>(pDestination, pSource, IsInline<T>());
+			break;
+		case Operation::Destroy:
+			pCall->~T();
+			Deallocate(pCall, IsInline<T>());
+			break;
+		case Operation::GetOwner:
+			return _DelegatesInteral::GetCallOwner(*pCall, 0);
+		}
+		return nullptr;
+	}
+
+	template<typename T>
+	static void Clone(void* pDestination, const T& call, std::true_type)
+	{
+		new (pDestination) T(call);
+	}
+
+	template<typename T>
+	static void Clone(void* pDestination, const T& call, std::false_type)
+	{
+		void* pMemory = _DelegatesInteral::Alloc(sizeof(T));
+		new (pMemory) T(call);
+		*static_cast<void**>(pDestination) = pMemory;
+	}
+
+	template<typename T>
+	static void Move(void* pDestination, void* pSource, std::true_type)
+	{
+		T* pCall = static_cast<T*>(pSource);
+		new (pDestination) T(std::move(*pCall));
+		pCall->~T();
+	}
+
+	//The heap allocation is handed over
+	template<typename T>
+	static void Move(void* pDestination, void* pSource, std::false_type)
+	{
+		*static_cast<void**>(pDestination) = *static_cast<void**>(pSource);
+	}
+
+	static void Deallocate(void*, std::true_type)
+	{
+	}
+
+	static void Deallocate(void* pMemory, std::false_type)
+	{
+		_DelegatesInteral::Free(pMemory);
+	}
+
+	void MoveFrom(InlineCompactDelegate& other) noexcept
+	{
+		if (other.m_pManager != nullptr)
+		{
+			other.m_pManager(Operation::Move, m_Storage, other.m_Storage);
+			m_pInvoker = other.m_pInvoker;
+			m_pManager = other.m_pManager;
+			other.m_pInvoker = nullptr;
+			other.m_pManager = nullptr;
+		}
+	}
+
+	void* GetStorage() const
+	{
+		return const_cast<char*>(m_Storage);
+	}
+
+	InvokerFunction m_pInvoker;
+	ManagerFunction m_pManager;
+	alignas(void*) char m_Storage[StorageSize];
+};
+
+template<typename RetVal, typename... Args>
+using CompactDelegate = InlineCompactDelegate<sizeof(void*), RetVal, Args...>;
+
+namespace _DelegatesInteral
+{
+	//Result of an asynchronous delegate call, constructed in place once the call finished
+	template<typename T>
+	class AsyncValue
+	{
+	public:
+		using ContinuationT = Delegate<void, const T&>;
+
+		AsyncValue() = default;
+		AsyncValue(const AsyncValue& other) = delete;
+		AsyncValue& operator=(const AsyncValue& other) = delete;
+
+		~AsyncValue() noexcept
+		{
+			if (m_HasValue)
+			{
+				reinterpret_cast<T*>(&m_Storage)->~T();
+			}
+		}
+
+		template<typename Function>
+		void Set(Function&& function)
+		{
+			new (&m_Storage) T(function());
+			m_HasValue = true;
+		}
+
+		const T& Get() const
+		{
+			DELEGATE_ASSERT(m_HasValue, "Asynchronous call has no result");
+			return *reinterpret_cast<const T*>(&m_Storage);
+		}
+
+		void Continue(const ContinuationT& continuation) const
+		{
+			continuation.Execute(Get());
+		}
+
+	private:
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type m_Storage;
+		bool m_HasValue = false;
+	};
+
+	template<>
+	class AsyncValue<void>
+	{
+	public:
+		using ContinuationT = Delegate<void>;
+
+		template<typename Function>
+		void Set(Function&& function)
+		{
+			function();
+		}
+
+		void Get() const
+		{
+		}
+
+		void Continue(const ContinuationT& continuation) const
+		{
+			continuation.Execute();
+		}
+	};
+}
+
+#if DELEGATE_EXCEPTIONS
+namespace Delegates
+{
+	//Thrown by DelegateFuture::Get when the call was cancelled
+	class CancelledError : public std::exception
+	{
+	public:
+		virtual const char* what() const noexcept override
+		{
+			return "Asynchronous delegate call was cancelled";
+		}
+	};
+}
+#endif
+
+//State shared by an asynchronous delegate call and its futures
+//Refcounted, the derived call type puts itself back in the pool when the last reference is released
+template<typename RetVal>
+class AsyncState
+{
+public:
+	static_assert(!std::is_reference<RetVal>::value, "Delegates returning a reference can't be executed asynchronously");
+
+	using ContinuationT = typename _DelegatesInteral::AsyncValue<RetVal>::ContinuationT;
+
+	void AddRef()
+	{
+		m_RefCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void Release()
+	{
+		if (m_RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Recycle();
+		}
+	}
+
+	bool IsReady() const
+	{
+		return m_Status.load(std::memory_order_acquire) == Status::Ready;
+	}
+
+	bool IsCancelled() const
+	{
+		return m_Status.load(std::memory_order_acquire) == Status::Cancelled;
+	}
+
+	//True if the call threw an exception
+	bool IsFailed() const
+	{
+		return m_Status.load(std::memory_order_acquire) == Status::Failed;
+	}
+
+	//Block until the call finished, failed or was cancelled
+	void Wait()
+	{
+		if (IsFinished() == false)
+		{
+			std::unique_lock<std::mutex> lock(m_Lock);
+			m_Finished.wait(lock, [this]() { return IsFinished(); });
+		}
+	}
+
+	//Prevent the call from running. Fails if it already started.
+	bool Cancel()
+	{
+		std::lock_guard<std::mutex> lock(m_Lock);
+		Status expected = Status::Pending;
+		if (m_Status.compare_exchange_strong(expected, Status::Cancelled))
+		{
+			m_Continuation.Clear();
+			m_Finished.notify_all();
+			return true;
+		}
+		return false;
+	}
+
+	//Runs right away if the result is already there, otherwise on the thread that finishes the call
+	//Never runs if the call is cancelled or failed
+	void Then(ContinuationT&& continuation)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			DELEGATE_ASSERT(m_Continuation.IsBound() == false, "Only a single continuation is supported");
+			if (IsFinished() == false)
+			{
+				m_Continuation = std::move(continuation);
+				return;
+			}
+		}
+		if (IsReady())
+		{
+			m_Value.Continue(continuation);
+		}
+	}
+
+	//Rethrows the exception of a failed call
+	//A cancelled call has no value: throws Delegates::CancelledError, or aborts without exceptions
+	decltype(auto) GetValue() const
+	{
+#if DELEGATE_EXCEPTIONS
+		if (IsFailed())
+		{
+			std::rethrow_exception(m_Exception);
+		}
+		if (IsCancelled())
+		{
+			throw Delegates::CancelledError();
+		}
+#else
+		if (IsCancelled())
+		{
+			std::abort();
+		}
+#endif
+		DELEGATE_ASSERT(IsReady(), "Asynchronous call is not finished");
+		return m_Value.Get();
+	}
+
+protected:
+	enum class Status
+	{
+		Pending,
+		Running,
+		Ready,
+		Cancelled,
+		Failed,
+	};
+
+	//The initial reference belongs to whoever runs the call
+	AsyncState()
+		: m_RefCount(1), m_Status(Status::Pending)
+	{}
+
+	virtual ~AsyncState() noexcept = default;
+
+	virtual void Recycle() = 0;
+
+	bool IsFinished() const
+	{
+		return m_Status.load(std::memory_order_acquire) >= Status::Ready;
+	}
+
+	template<typename Function>
+	void Run(Function&& function)
+	{
+		Status expected = Status::Pending;
+		if (m_Status.compare_exchange_strong(expected, Status::Running) == false)
+		{
+			return;
+		}
+#if DELEGATE_EXCEPTIONS
+		try
+		{
+			m_Value.Set(std::forward<Function>(function));
+		}
+		catch (...)
+		{
+			//Finish the call so waiting threads don't block forever
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Exception = std::current_exception();
+			m_Status.store(Status::Failed, std::memory_order_release);
+			m_Continuation.Clear();
+			m_Finished.notify_all();
+			return;
+		}
+#else
+		m_Value.Set(std::forward<Function>(function));
+#endif
+		ContinuationT continuation;
+		{
+			std::lock_guard<std::mutex> lock(m_Lock);
+			m_Status.store(Status::Ready, std::memory_order_release);
+			continuation = std::move(m_Continuation);
+			m_Finished.notify_all();
+		}
+		if (continuation.IsBound())
+		{
+			m_Value.Continue(continuation);
+		}
+	}
+
+private:
+	std::atomic<unsigned int> m_RefCount;
+	std::atomic<Status> m_Status;
+	std::mutex m_Lock;
+	std::condition_variable m_Finished;
+	_DelegatesInteral::AsyncValue<RetVal> m_Value;
+	ContinuationT m_Continuation;
+#if DELEGATE_EXCEPTIONS
+	std::exception_ptr m_Exception;
+#endif
+};
+
+//A call of Delegate::ExecuteOn, owns a copy of the delegate and the arguments
+//Allocated from the SlabAllocator so the calls don't need a heap allocation each
+template<size_t InlineSize, typename RetVal, typename... Args>
+class AsyncDelegateCall : public AsyncState<RetVal>
+{
+public:
+	using DelegateT = InlineDelegate<InlineSize, RetVal, Args...>;
+
+	template<typename... Args2>
+	static AsyncDelegateCall* Create(const DelegateT& callback, Args2&&... args)
+	{
+		void* pMemory = Delegates::SlabAllocator::Allocate(sizeof(AsyncDelegateCall));
+		return new (pMemory) AsyncDelegateCall(callback, std::forward<Args2>(args)...);
+	}
+
+	//Task for IExecutor::Post, releases the reference of the executor afterwards
+	static void Execute(void* pContext, size_t /*index*/)
+	{
+		AsyncDelegateCall* pCall = static_cast<AsyncDelegateCall*>(pContext);
+		pCall->Run([pCall]() { return pCall->Invoke(std::index_sequence_for<Args...>()); });
+		pCall->Release();
+	}
+
+private:
+	template<typename... Args2>
+	AsyncDelegateCall(const DelegateT& callback, Args2&&... args)
+		: m_Delegate(callback), m_Arguments(std::forward<Args2>(args)...)
+	{}
+
+	virtual void Recycle() override
+	{
+		this->~AsyncDelegateCall();
+		Delegates::SlabAllocator::Free(this);
+	}
+
+	template<size_t... Is>
+	RetVal Invoke(std::index_sequence<Is...>)
+	{
+		return m_Delegate.Execute(std::forward<Args>(std::get<Is>(m_Arguments))...);
+	}
+
+	DelegateT m_Delegate;
+	std::tuple<typename std::decay<Args>::type...> m_Arguments;
+};
+
+//Result of Delegate::ExecuteOn/ExecuteAsync
+//Copies share the same result
+template<typename RetVal>
+class DelegateFuture
+{
+public:
+	using ContinuationT = typename AsyncState<RetVal>::ContinuationT;
+
+	constexpr DelegateFuture() noexcept
+		: m_pState(nullptr)
+	{}
+
+	explicit DelegateFuture(AsyncState<RetVal>* pState) noexcept
+		: m_pState(pState)
+	{
+		m_pState->AddRef();
+	}
+
+	~DelegateFuture() noexcept
+	{
+		Reset();
+	}
+
+	DelegateFuture(const DelegateFuture& other) noexcept
+		: m_pState(other.m_pState)
+	{
+		if (m_pState != nullptr)
+		{
+			m_pState->AddRef();
+		}
+	}
+
+	DelegateFuture& operator=(const DelegateFuture& other) noexcept
+	{
+		if (other.m_pState != nullptr)
+		{
+			other.m_pState->AddRef();
+		}
+		Reset();
+		m_pState = other.m_pState;
+		return *this;
+	}
+
+	DelegateFuture(DelegateFuture&& other) noexcept
+		: m_pState(other.m_pState)
+	{
+		other.m_pState = nullptr;
+	}
+
+	DelegateFuture& operator=(DelegateFuture&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_pState = other.m_pState;
+			other.m_pState = nullptr;
+		}
+		return *this;
+	}
+
+	bool IsValid() const
+	{
+		return m_pState != nullptr;
+	}
+
+	bool IsReady() const
+	{
+		return m_pState != nullptr && m_pState->IsReady();
+	}
+
+	bool IsCancelled() const
+	{
+		return m_pState != nullptr && m_pState->IsCancelled();
+	}
+
+	bool IsFailed() const
+	{
+		return m_pState != nullptr && m_pState->IsFailed();
+	}
+
+	//Block until the call finished, failed or was cancelled
+	void Wait() const
+	{
+		DELEGATE_ASSERT(IsValid(), "Future is not valid");
+		m_pState->Wait();
+	}
+
+	//Block until the call finished and return the result
+	//Rethrows the exception if the call threw. Throws Delegates::CancelledError if the call was cancelled
+	//(aborts when compiled without exceptions, check IsCancelled() first)
+	decltype(auto) Get() const
+	{
+		Wait();
+		return m_pState->GetValue();
+	}
+
+	//Prevent the call from running. Returns false if it already started or finished.
+	bool Cancel()
+	{
+		DELEGATE_ASSERT(IsValid(), "Future is not valid");
+		return m_pState->Cancel();
+	}
+
+	//Called with the result when the call finishes, right away if it already finished
+	//Runs on the thread that finished the call. Only one continuation per call.
+	void Then(ContinuationT&& continuation)
+	{
+		DELEGATE_ASSERT(IsValid(), "Future is not valid");
+		m_pState->Then(std::move(continuation));
+	}
+
+	template<typename LambdaType, typename... Args2>
+	void ThenLambda(LambdaType&& lambda, Args2&&... args)
+	{
+		Then(ContinuationT::CreateLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...));
+	}
+
+	//Drop the reference to the result
+	void Reset()
+	{
+		if (m_pState != nullptr)
+		{
+			m_pState->Release();
+			m_pState = nullptr;
+		}
+	}
+
+private:
+	AsyncState<RetVal>* m_pState;
+};
+
+//Listeners of a multicast delegate, shared by InlineMulticastDelegate and InlineMulticastDelegateRet
+//Adding and removing are constant time: a handle refers to a slot which holds the index of its delegate in the arrays.
+//The derived classes only add the ways to broadcast.
+template<size_t InlineSize, typename RetVal, typename... Args>
+class MulticastDelegateBase
+{
+public:
+	using DelegateT = InlineDelegate<InlineSize, RetVal, Args...>;
+
+protected:
+	//Executes a batch delegate with the whole batch. Returns false if the bound object expired.
+	using BatchInvokerFunction = bool(*)(void* pDelegate, const Delegates::Span<const std::tuple<Args...>>& batch);
+
+	//Everything Broadcast needs to call a delegate
+	//pInvoker is nullptr for delegates that were removed while broadcasting
+	struct InvokeRecord
+	{
+		typename DelegateT::InvokerFunction pInvoker;
+		void* pDelegate;
+	};
+	template<typename T, typename... Args2>
+	using ConstMemberFunction = typename _DelegatesInteral::MemberFunction<true, T, RetVal, Args..., Args2...>::Type;
+	template<typename T, typename... Args2>
+	using NonConstMemberFunction = typename _DelegatesInteral::MemberFunction<false, T, RetVal, Args..., Args2...>::Type;
+
+public:
+	//Default constructor
+	constexpr MulticastDelegateBase()
+		: m_FreeSlot(DelegateHandle::INVALID_ID), m_NumInvalid(0), m_Locks(0), m_Ordered(false), m_Unsorted(false)
+	{
+	}
+
+#if DELEGATE_PMR
+	//The listener arrays are allocated from the memory resource, see InlineMulticastDelegate
+	explicit MulticastDelegateBase(std::pmr::memory_resource* pResource)
+		: m_Invokers(pResource), m_BatchInvokers(pResource), m_Callbacks(pResource), m_Handles(pResource), m_Priorities(pResource), m_Slots(pResource), m_FreeSlot(DelegateHandle::INVALID_ID), m_NumInvalid(0), m_Locks(0), m_Ordered(false), m_Unsorted(false)
+	{
+	}
+#endif
+
+	//Default destructor
+	//Not virtual: multicast delegates are never deleted through a MulticastDelegateBase pointer
+	~MulticastDelegateBase() noexcept = default;
+
+	//Copy constructor
+	//The invoke records point into the delegates so they are rebuilt for the copies
+	MulticastDelegateBase(const MulticastDelegateBase& other)
+		: m_Invokers(other.m_Invokers),
+		m_BatchInvokers(other.m_BatchInvokers),
+		m_Callbacks(other.m_Callbacks),
+		m_Handles(other.m_Handles),
+		m_Priorities(other.m_Priorities),
+		m_Slots(other.m_Slots),
+		m_FreeSlot(other.m_FreeSlot),
+		m_NumInvalid(other.m_NumInvalid),
+		m_Locks(0),
+		m_Ordered(other.m_Ordered),
+		m_Unsorted(false)
+	{
+		RefreshInvokers();
+		if (other.m_Unsorted)
+		{
+			SortByPriority();
+		}
+	}
+
+	//Copy assignment operator
+	MulticastDelegateBase& operator=(const MulticastDelegateBase& other)
+	{
+		if (this != &other)
+		{
+			m_Invokers = other.m_Invokers;
+			m_BatchInvokers = other.m_BatchInvokers;
+			m_Callbacks = other.m_Callbacks;
+			m_Handles = other.m_Handles;
+			m_Priorities = other.m_Priorities;
+			m_Slots = other.m_Slots;
+			m_FreeSlot = other.m_FreeSlot;
+			m_NumInvalid = other.m_NumInvalid;
+			m_Ordered = other.m_Ordered;
+			m_Unsorted = other.m_Unsorted;
+			RefreshInvokers();
+			if (m_Unsorted && IsLocked() == false)
+			{
+				SortByPriority();
+			}
+		}
+		return *this;
+	}
+
+	//Move constructor
+	//The array memory is taken over so the invoke records stay valid
+	MulticastDelegateBase(MulticastDelegateBase&& other) noexcept
+		: m_Invokers(std::move(other.m_Invokers)),
+		m_BatchInvokers(std::move(other.m_BatchInvokers)),
+		m_Callbacks(std::move(other.m_Callbacks)),
+		m_Handles(std::move(other.m_Handles)),
+		m_Priorities(std::move(other.m_Priorities)),
+		m_Slots(std::move(other.m_Slots)),
+		m_FreeSlot(other.m_FreeSlot),
+		m_NumInvalid(other.m_NumInvalid),
+		m_Locks(std::move(other.m_Locks)),
+		m_Ordered(other.m_Ordered),
+		m_Unsorted(other.m_Unsorted)
+	{
+		other.m_FreeSlot = DelegateHandle::INVALID_ID;
+		other.m_NumInvalid = 0;
+	}
+
+	//Move assignment operator
+	//Arrays with a different memory resource are moved element wise so the invoke records are rebuilt
+	MulticastDelegateBase& operator=(MulticastDelegateBase&& other) noexcept
+	{
+		m_Invokers = std::move(other.m_Invokers);
+		m_BatchInvokers = std::move(other.m_BatchInvokers);
+		m_Callbacks = std::move(other.m_Callbacks);
+		m_Handles = std::move(other.m_Handles);
+		m_Priorities = std::move(other.m_Priorities);
+		m_Slots = std::move(other.m_Slots);
+		m_FreeSlot = other.m_FreeSlot;
+		m_NumInvalid = other.m_NumInvalid;
+		m_Locks = std::move(other.m_Locks);
+		m_Ordered = other.m_Ordered;
+		m_Unsorted = other.m_Unsorted;
+		other.m_FreeSlot = DelegateHandle::INVALID_ID;
+		other.m_NumInvalid = 0;
+		RefreshInvokers();
+		return *this;
+	}
+
+	template<typename T>
+	DelegateHandle operator+=(T&& l)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateLambda(std::move(l)));
+	}
+
+	//Add delegate with the += operator
+	DelegateHandle operator+=(DelegateT&& handler) noexcept
+	{
+		return Add(std::forward<DelegateT>(handler));
+	}
+
+	//Remove a delegate using its DelegateHandle
+	bool operator-=(DelegateHandle& handle)
+	{
+		return Remove(handle);
+	}
+
+	DelegateHandle Add(DelegateT&& handler) noexcept
+	{
+		return AddWithPriority(std::move(handler), 0);
+	}
+
+	//Add a delegate that is executed before the delegates with a lower priority
+	//Delegates with the same priority are executed in the order they were added.
+	//From then on removing keeps the order, which is linear instead of constant time.
+	DelegateHandle Add(DelegateT&& handler, int priority) noexcept
+	{
+		m_Ordered = true;
+		return AddWithPriority(std::move(handler), priority);
+	}
+
+	//Change the priority of a delegate, it moves behind the delegates that already have that priority
+	//Returns false if the handle isn't bound to this delegate
+	bool SetPriority(const DelegateHandle& handle, int priority)
+	{
+		size_t index = Find(handle);
+		if (index == DelegateHandle::INVALID_ID)
+		{
+			return false;
+		}
+		m_Ordered = true;
+		if (m_Priorities[index] != priority)
+		{
+			m_Priorities[index] = priority;
+			if (IsLocked())
+			{
+				//Moving it now would change the order of the arrays, sorted in Unlock()
+				m_Unsorted = true;
+			}
+			else if (index > 0 && m_Priorities[index - 1] < priority)
+			{
+				Rotate(FindPosition(0, index, priority), index, index + 1);
+			}
+			else
+			{
+				Rotate(index, index + 1, FindPosition(index + 1, m_Priorities.size(), priority));
+			}
+		}
+		return true;
+	}
+
+	//Returns the priority of the delegate or 0 if the handle isn't bound to this delegate
+	int GetPriority(const DelegateHandle& handle) const
+	{
+		size_t index = Find(handle);
+		return index != DelegateHandle::INVALID_ID ? m_Priorities[index] : 0;
+	}
+
+private:
+	DelegateHandle AddWithPriority(DelegateT&& handler, int priority) noexcept
+	{
+		//Favour an empty slot over a possible array reallocation
+		unsigned int slot = m_FreeSlot;
+		if (slot != DelegateHandle::INVALID_ID)
+		{
+			m_FreeSlot = m_Slots[slot];
+		}
+		else
+		{
+			slot = (unsigned int)m_Slots.size();
+			m_Slots.push_back(DelegateHandle::INVALID_ID);
+		}
+		m_Slots[slot] = (unsigned int)m_Callbacks.size();
+		m_Handles.emplace_back(true, slot);
+		m_Invokers.push_back(InvokeRecord());
+		m_BatchInvokers.push_back(nullptr);
+		m_Priorities.push_back(priority);
+		const DelegateT* pOldCallbacks = m_Callbacks.data();
+		m_Callbacks.push_back(std::move(handler));
+		if (m_Callbacks.data() == pOldCallbacks)
+		{
+			RefreshInvoker(m_Callbacks.size() - 1);
+		}
+		else
+		{
+			//Inline delegates moved when the array grew
+			RefreshInvokers();
+		}
+		DelegateHandle handle = m_Handles.back();
+		if (m_Ordered)
+		{
+			const size_t last = m_Callbacks.size() - 1;
+			if (IsLocked())
+			{
+				//Executed at the end of this broadcast, sorted in Unlock()
+				m_Unsorted = true;
+			}
+			else if (last > 0 && m_Priorities[last - 1] < priority)
+			{
+				const size_t position = FindPosition(0, last, priority);
+				//Fill the closest removed delegate instead of shifting everything behind the position
+				size_t gap = FindGap(position, last - position);
+				if (gap == DelegateHandle::INVALID_ID)
+				{
+					Rotate(position, last, last + 1);
+				}
+				else
+				{
+					if (gap < position)
+					{
+						Rotate(gap, gap + 1, position);
+						gap = position - 1;
+					}
+					else
+					{
+						Rotate(position, gap, gap + 1);
+						gap = position;
+					}
+					MoveElement(gap, last);
+					PopBack();
+					--m_NumInvalid;
+				}
+			}
+		}
+		return handle;
+	}
+
+public:
+
+	//Bind a member function
+	template<typename T, typename... Args2>
+	DelegateHandle AddRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateRaw(pObject, pFunction, std::forward<Args2>(args)...));
+	}
+
+	template<typename T, typename... Args2>
+	DelegateHandle AddRaw(T* pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateRaw(pObject, pFunction, std::forward<Args2>(args)...));
+	}
+
+	//Bind a static/global function
+	template<typename... Args2>
+	DelegateHandle AddStatic(RetVal(*pFunction)(Args..., Args2...), Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateStatic(pFunction, std::forward<Args2>(args)...));
+	}
+
+	//Bind a lambda
+	template<typename LambdaType, typename... Args2>
+	DelegateHandle AddLambda(LambdaType&& lambda, Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...));
+	}
+
+	//Bind a member function with a shared_ptr object
+	template<typename T, typename... Args2>
+	DelegateHandle AddSP(std::shared_ptr<T> pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateSP(pObject, pFunction, std::forward<Args2>(args)...));
+	}
+
+	template<typename T, typename... Args2>
+	DelegateHandle AddSP(std::shared_ptr<T> pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = GetMemoryResourceScope();
+		return Add(DelegateT::CreateSP(pObject, pFunction, std::forward<Args2>(args)...));
+	}
+
+	//Removes all handles that are bound from a specific object
+	//Ignored when pObject is null
+	//Note: Only works on Raw and SP bindings
+	void RemoveObject(void* pObject)
+	{
+		if (pObject != nullptr)
+		{
+			//Locked so removing only invalidates and the arrays don't change while iterating
+			//They are compressed once in Unlock()
+			Lock();
+			for (size_t i = 0; i < m_Callbacks.size(); ++i)
+			{
+				if (m_Handles[i].IsValid() && m_Callbacks[i].GetOwner() == pObject)
+				{
+					RemoveAt(i);
+				}
+			}
+			Unlock();
+		}
+	}
+
+	//Remove a function from the event list by the handle
+	//Constant time, the handle knows the slot of its delegate
+	bool Remove(DelegateHandle& handle)
+	{
+		size_t index = Find(handle);
+		if (index != DelegateHandle::INVALID_ID)
+		{
+			RemoveAt(index);
+			handle.Reset();
+			return true;
+		}
+		return false;
+	}
+
+	bool IsBoundTo(const DelegateHandle& handle) const
+	{
+		return Find(handle) != DelegateHandle::INVALID_ID;
+	}
+
+	//Remove all the functions bound to the delegate
+	void RemoveAll()
+	{
+		if (IsLocked())
+		{
+			for (size_t i = 0; i < m_Callbacks.size(); ++i)
+			{
+				Invalidate(i);
+			}
+		}
+		else
+		{
+			m_Invokers.clear();
+			m_BatchInvokers.clear();
+			m_Callbacks.clear();
+			m_Handles.clear();
+			m_Priorities.clear();
+			m_NumInvalid = 0;
+		}
+		m_Slots.clear();
+		m_FreeSlot = DelegateHandle::INVALID_ID;
+	}
+
+	//Remove the delegates that were removed while broadcasting
+	//Happens automatically at the end of a broadcast
+	void Compress(size_t maxSpace = 0)
+	{
+		if (IsLocked() == false)
+		{
+			//Kept up to date so Unlock() doesn't need to visit the handles
+			if (m_NumInvalid > maxSpace && m_Ordered)
+			{
+				CompressOrdered();
+			}
+			else if (m_NumInvalid > maxSpace)
+			{
+				for (size_t i = m_Handles.size(); i > 0; --i)
+				{
+					if (m_Handles[i - 1].IsValid() == false)
+					{
+						RemoveAt(i - 1);
+					}
+				}
+			}
+		}
+	}
+
+	//Delegates removed while broadcasting are counted until the broadcast is done
+	size_t GetSize() const
+	{
+		return m_Callbacks.size() - (IsLocked() ? 0 : m_NumInvalid);
+	}
+
+protected:
+	void Lock()
+	{
+		++m_Locks;
+	}
+
+	void Unlock()
+	{
+		//Unlock() should never be called more than Lock()!
+		DELEGATE_ASSERT(m_Locks > 0);
+		--m_Locks;
+		Compress();
+		if (m_Unsorted && IsLocked() == false)
+		{
+			SortByPriority();
+		}
+	}
+
+	//Returns true is the delegate is currently broadcasting
+	//If this is true, the order of the array should not be changed otherwise this causes undefined behaviour
+	bool IsLocked() const
+	{
+		return m_Locks > 0;
+	}
+
+	//Scope that makes delegates that are bound in it allocate from the memory resource of the delegate
+	_DelegatesInteral::MemoryResourceScope GetMemoryResourceScope() const
+	{
+#if DELEGATE_PMR
+		std::pmr::memory_resource* pResource = m_Callbacks.get_allocator().resource();
+		return _DelegatesInteral::MemoryResourceScope(pResource != std::pmr::get_default_resource() ? pResource : nullptr);
+#else
+		return _DelegatesInteral::MemoryResourceScope(nullptr);
+#endif
+	}
+
+	//Returns the index of the delegate the handle refers to or INVALID_ID
+	//Stale handles are detected because the ID of the handle won't match the one in the slot anymore
+	size_t Find(const DelegateHandle& handle) const
+	{
+		if (handle.IsValid() && handle.GetIndex() < m_Slots.size())
+		{
+			unsigned int index = m_Slots[handle.GetIndex()];
+			if (index < m_Handles.size() && m_Handles[index] == handle)
+			{
+				return index;
+			}
+		}
+		return DelegateHandle::INVALID_ID;
+	}
+
+	//Push the slot on the free list. The free slot stores the next free slot.
+	//A handle to a free slot can't match any delegate because the IDs won't match.
+	void FreeSlot(unsigned int slot)
+	{
+		m_Slots[slot] = m_FreeSlot;
+		m_FreeSlot = slot;
+	}
+
+	//Point the invoke record to its delegate again
+	//Required whenever a delegate moved because its inline allocation moves with it
+	void RefreshInvoker(size_t index)
+	{
+		const DelegateT& callback = m_Callbacks[index];
+		m_Invokers[index].pInvoker = callback.IsBound() ? callback.m_pInvoker : nullptr;
+		m_Invokers[index].pDelegate = callback.m_Allocator.GetAllocation();
+	}
+
+	void RefreshInvokers()
+	{
+		for (size_t i = 0; i < m_Callbacks.size(); ++i)
+		{
+			RefreshInvoker(i);
+		}
+	}
+
+	//Remove the delegate without changing the order of the arrays
+	void Invalidate(size_t index)
+	{
+		m_NumInvalid += m_Handles[index].IsValid();
+		m_Invokers[index].pInvoker = nullptr;
+		m_Callbacks[index].Clear();
+		m_Handles[index].Reset();
+	}
+
+	//Remove the delegate at the given index
+	//While broadcasting, the delegate is only invalidated so the order of the arrays doesn't change.
+	//Otherwise, the last delegate takes its place and its slot is updated.
+	void RemoveAt(size_t index)
+	{
+		if (m_Handles[index].IsValid())
+		{
+			FreeSlot(m_Handles[index].GetIndex());
+		}
+		if (IsLocked())
+		{
+			Invalidate(index);
+		}
+		else if (m_Ordered)
+		{
+			//Shifting would make every remove linear, the gaps are filled by Add or compressed in one go
+			Invalidate(index);
+			if (m_NumInvalid > m_Callbacks.size() / 2)
+			{
+				CompressOrdered();
+			}
+		}
+		else
+		{
+			m_NumInvalid -= m_Handles[index].IsValid() == false;
+			size_t last = m_Callbacks.size() - 1;
+			if (index != last)
+			{
+				MoveElement(index, last);
+			}
+			PopBack();
+		}
+	}
+
+	//Move the delegate at index from to index to, overwriting the delegate there
+	void MoveElement(size_t to, size_t from)
+	{
+		m_Callbacks[to] = std::move(m_Callbacks[from]);
+		m_BatchInvokers[to] = m_BatchInvokers[from];
+		m_Handles[to] = m_Handles[from];
+		m_Priorities[to] = m_Priorities[from];
+		RefreshInvoker(to);
+		if (m_Handles[to].IsValid())
+		{
+			m_Slots[m_Handles[to].GetIndex()] = (unsigned int)to;
+		}
+	}
+
+	void PopBack()
+	{
+		m_Invokers.pop_back();
+		m_BatchInvokers.pop_back();
+		m_Callbacks.pop_back();
+		m_Handles.pop_back();
+		m_Priorities.pop_back();
+	}
+
+	//Returns the index of the removed delegate closest to position within maxDistance or INVALID_ID
+	size_t FindGap(size_t position, size_t maxDistance) const
+	{
+		if (m_NumInvalid > 0)
+		{
+			for (size_t distance = 0; distance < maxDistance; ++distance)
+			{
+				if (position + distance < m_Handles.size() && m_Handles[position + distance].IsValid() == false)
+				{
+					return position + distance;
+				}
+				if (distance < position && m_Handles[position - distance - 1].IsValid() == false)
+				{
+					return position - distance - 1;
+				}
+			}
+		}
+		return DelegateHandle::INVALID_ID;
+	}
+
+	//Returns the first index in [first, last) with a lower priority, the delegates are sorted from high to low
+	size_t FindPosition(size_t first, size_t last, int priority) const
+	{
+		return std::upper_bound(m_Priorities.begin() + first, m_Priorities.begin() + last, priority, std::greater<int>()) - m_Priorities.begin();
+	}
+
+	//Move the delegates in [middle, last) in front of the ones in [first, middle) like std::rotate
+	void Rotate(size_t first, size_t middle, size_t last)
+	{
+		if (first == middle || middle == last)
+		{
+			return;
+		}
+		std::rotate(m_Invokers.begin() + first, m_Invokers.begin() + middle, m_Invokers.begin() + last);
+		std::rotate(m_BatchInvokers.begin() + first, m_BatchInvokers.begin() + middle, m_BatchInvokers.begin() + last);
+		std::rotate(m_Callbacks.begin() + first, m_Callbacks.begin() + middle, m_Callbacks.begin() + last);
+		std::rotate(m_Handles.begin() + first, m_Handles.begin() + middle, m_Handles.begin() + last);
+		std::rotate(m_Priorities.begin() + first, m_Priorities.begin() + middle, m_Priorities.begin() + last);
+		for (size_t i = first; i < last; ++i)
+		{
+			RefreshInvoker(i);
+			if (m_Handles[i].IsValid())
+			{
+				m_Slots[m_Handles[i].GetIndex()] = (unsigned int)i;
+			}
+		}
+	}
+
+	//Stable insertion sort, only the delegates added or changed while broadcasting are out of place
+	void SortByPriority()
+	{
+		for (size_t i = 1; i < m_Priorities.size(); ++i)
+		{
+			if (m_Priorities[i - 1] < m_Priorities[i])
+			{
+				Rotate(FindPosition(0, i, m_Priorities[i]), i, i + 1);
+			}
+		}
+		m_Unsorted = false;
+	}
+
+	//Remove all the invalidated delegates in a single pass while keeping the order
+	void CompressOrdered()
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < m_Handles.size(); ++i)
+		{
+			if (m_Handles[i].IsValid())
+			{
+				if (i != count)
+				{
+					MoveElement(count, i);
+				}
+				++count;
+			}
+		}
+		m_Invokers.erase(m_Invokers.begin() + count, m_Invokers.end());
+		m_BatchInvokers.erase(m_BatchInvokers.begin() + count, m_BatchInvokers.end());
+		m_Callbacks.erase(m_Callbacks.begin() + count, m_Callbacks.end());
+		m_Handles.erase(m_Handles.begin() + count, m_Handles.end());
+		m_Priorities.erase(m_Priorities.begin() + count, m_Priorities.end());
+		m_NumInvalid = 0;
+	}
+
+	//Structure of arrays, index i in each array belongs to the same delegate.
+	//In no particular order, unless a priority was given. Then they are sorted from high to low priority.
+	//Hot: what Broadcast reads for every delegate
+	_DelegatesInteral::Vector<InvokeRecord> m_Invokers;
+	//Only read by InlineMulticastDelegate::BroadcastBatch: the batch invoker of delegates added with AddBatch, otherwise nullptr
+	_DelegatesInteral::Vector<BatchInvokerFunction> m_BatchInvokers;
+	//Cold: the delegates that own the bound objects
+	_DelegatesInteral::Vector<DelegateT> m_Callbacks;
+	//Cold: handles of the delegates, invalid for delegates removed while broadcasting
+	_DelegatesInteral::Vector<DelegateHandle> m_Handles;
+	//Cold: priorities of the delegates, 0 unless given
+	_DelegatesInteral::Vector<int> m_Priorities;
+	//Maps the index of a DelegateHandle to the index in the arrays above.
+	//Free slots form an intrusive list and hold the index of the next free slot instead.
+	_DelegatesInteral::Vector<unsigned int> m_Slots;
+	//First free slot or INVALID_ID
+	unsigned int m_FreeSlot;
+	//Delegates that were removed while broadcasting and still need to be compressed
+	unsigned int m_NumInvalid;
+	unsigned int m_Locks;
+	//Keep the delegates sorted by priority, set once a priority is given
+	bool m_Ordered;
+	//Delegates were added or changed priority while broadcasting and need to be sorted
+	bool m_Unsorted;
+};
+
+//Delegate that can be bound to by MULTIPLE objects
+//InlineSize is the inline allocation size of every bound delegate.
+//Use the MulticastDelegate alias for the default size (DELEGATE_INLINE_ALLOCATION_SIZE)
+template<size_t InlineSize, typename... Args>
+class InlineMulticastDelegate : public MulticastDelegateBase<InlineSize, void, Args...>
+{
+	using Base = MulticastDelegateBase<InlineSize, void, Args...>;
+
+public:
+	using DelegateT = typename Base::DelegateT;
+	//The arguments of a single Broadcast, BroadcastBatch takes a span of these
+	using ArgumentTuple = std::tuple<Args...>;
+	using BatchT = Delegates::Span<const ArgumentTuple>;
+	//Delegate that receives all the arguments of a BroadcastBatch at once
+	using BatchDelegateT = InlineDelegate<InlineSize, void, BatchT>;
+
+private:
+	using BatchDelegateType = BatchDelegate<BatchDelegateT, Args...>;
+	using InvokeRecord = typename Base::InvokeRecord;
+
+public:
+	//Default constructor
+	InlineMulticastDelegate() = default;
+
+#if DELEGATE_PMR
+	//The listener arrays are allocated from the memory resource.
+	//Delegates that are bound with the Add functions (except Add(DelegateT&&)) are heap allocated from it as well.
+	//Like std::pmr containers, copies use the default resource.
+	explicit InlineMulticastDelegate(std::pmr::memory_resource* pResource)
+		: Base(pResource)
+	{
+	}
+#endif
+
+	//Add a delegate that receives all the arguments of a BroadcastBatch at once instead of one by one
+	//Broadcast passes a batch with a single element
+	DelegateHandle AddBatch(BatchDelegateT&& handler)
+	{
+		DELEGATE_ASSERT(handler.IsBound(), "Batch delegate is not bound");
+		_DelegatesInteral::MemoryResourceScope scope = this->GetMemoryResourceScope();
+		DelegateT callback;
+		callback.template Bind<BatchDelegateType>(std::move(handler));
+		DelegateHandle handle = this->Add(std::move(callback));
+		this->m_BatchInvokers[this->Find(handle)] = &InvokeBatch;
+		return handle;
+	}
+
+	//Bind a lambda that receives a BatchT
+	template<typename LambdaType, typename... Args2>
+	DelegateHandle AddBatchLambda(LambdaType&& lambda, Args2&&... args)
+	{
+		_DelegatesInteral::MemoryResourceScope scope = this->GetMemoryResourceScope();
+		return AddBatch(BatchDelegateT::CreateLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...));
+	}
+
+	//Execute all functions that are bound, the ones with a higher priority first
+	//Delegates bound to a std::shared_ptr that expired are removed
+	//Only the dense invoke records are read, handles and delegates are not touched
+	//Large arguments are taken by reference, each delegate receives its own copy made right before it is called.
+	void Broadcast(_DelegatesInteral::ParameterType<Args>... args)
+	{
+		this->Lock();
+		for (size_t i = 0; i < this->m_Invokers.size(); ++i)
+		{
+			//Copy, a delegate can add delegates and reallocate the array
+			InvokeRecord record = this->m_Invokers[i];
+			if (record.pInvoker != nullptr && record.pInvoker(record.pDelegate, Args(args)...) == false)
+			{
+				//Only invalidated while broadcasting, removed by Compress() in Unlock()
+				this->RemoveAt(i);
+			}
+		}
+		this->Unlock();
+	}
+
+	//Execute all functions that are bound once for every element of the batch
+	//The delegates are the outer loop so every delegate stays hot in the cache for the whole batch
+	//Delegates added with AddBatch receive the whole batch at once
+	void BroadcastBatch(BatchT batch)
+	{
+		this->Lock();
+		for (size_t i = 0; i < this->m_Invokers.size(); ++i)
+		{
+			bool alive = true;
+			if (this->m_Invokers[i].pInvoker != nullptr)
+			{
+				if (this->m_BatchInvokers[i] != nullptr)
+				{
+					alive = this->m_BatchInvokers[i](this->m_Invokers[i].pDelegate, batch);
+				}
+				else
+				{
+					for (const ArgumentTuple& arguments : batch)
+					{
+						//Reload the record every time, the delegate can remove itself or add delegates
+						InvokeRecord record = this->m_Invokers[i];
+						if (record.pInvoker == nullptr)
+						{
+							break;
+						}
+						if (Invoke(record, arguments, std::index_sequence_for<Args...>()) == false)
+						{
+							alive = false;
+							break;
+						}
+					}
+				}
+			}
+			if (alive == false)
+			{
+				//Only invalidated while broadcasting, removed by Compress() in Unlock()
+				this->RemoveAt(i);
+			}
+		}
+		this->Unlock();
+	}
+
+	//Execute all functions that are bound in parallel on the executor and wait for them to finish
+	//Only for delegates that are independent of each other and can run on any thread. Priorities are ignored.
+	//Delegates can't be added or removed while broadcasting in parallel.
+	void BroadcastParallel(Delegates::IExecutor& executor, _DelegatesInteral::ParameterType<Args>... args)
+	{
+		this->Lock();
+		ParallelBroadcast broadcast(*this, args...);
+		executor.ParallelFor(this->m_Invokers.size(), &ParallelBroadcast::Execute, &broadcast);
+		for (size_t index : broadcast.Expired)
+		{
+			this->RemoveAt(index);
+		}
+		this->Unlock();
+	}
+
+	//Broadcast in parallel on the default executor
+	void BroadcastParallel(_DelegatesInteral::ParameterType<Args>... args)
+	{
+		BroadcastParallel(Delegates::WorkStealingExecutor::GetDefault(), args...);
+	}
+
+private:
+	//State of a BroadcastParallel shared by all tasks
+	struct ParallelBroadcast
+	{
+		ParallelBroadcast(const InlineMulticastDelegate& owner, _DelegatesInteral::ParameterType<Args>... args)
+			: Owner(owner), Arguments(args...)
+		{}
+
+		static void Execute(void* pContext, size_t index)
+		{
+			ParallelBroadcast& broadcast = *static_cast<ParallelBroadcast*>(pContext);
+			const InvokeRecord& record = broadcast.Owner.m_Invokers[index];
+			if (record.pInvoker != nullptr && Invoke(record, broadcast.Arguments, std::index_sequence_for<Args...>()) == false)
+			{
+				//Rare, so a lock is fine
+				std::lock_guard<std::mutex> lock(broadcast.ExpiredLock);
+				broadcast.Expired.push_back(index);
+			}
+		}
+
+		const InlineMulticastDelegate& Owner;
+		ArgumentTuple Arguments;
+		//Delegates bound to a std::shared_ptr that expired, removed after the broadcast
+		std::mutex ExpiredLock;
+		std::vector<size_t> Expired;
+	};
+
+	template<size_t... Is>
+	static bool Invoke(const InvokeRecord& record, const ArgumentTuple& arguments, std::index_sequence<Is...>)
+	{
+		(void)arguments;
+		return record.pInvoker(record.pDelegate, Args(std::get<Is>(arguments))...);
+	}
+
+	static bool InvokeBatch(void* pDelegate, const BatchT& batch)
+	{
+		return static_cast<BatchDelegateType*>(pDelegate)->ExecuteBatch(batch);
+	}
+};
+
+template<typename... Args>
+using MulticastDelegate = InlineMulticastDelegate<DELEGATE_INLINE_ALLOCATION_SIZE, Args...>;
+
+//MulticastDelegate that is a single pointer while nothing is bound to it
+//Meant for objects that exist in large numbers and rarely have listeners, eg. an event on every entity.
+//The listeners are kept in an InlineMulticastDelegate that is heap allocated on the first Add and freed again
+//when the last listener is removed, or at the end of the broadcast it was removed in.
+//Use GetListeners() for functionality that isn't forwarded, like BroadcastBatch.
+template<size_t InlineSize, typename... Args>
+class InlineCompactMulticastDelegate
+{
+public:
+	using MulticastT = InlineMulticastDelegate<InlineSize, Args...>;
+	using DelegateT = typename MulticastT::DelegateT;
+
+private:
+	template<typename T, typename... Args2>
+	using ConstMemberFunction = typename _DelegatesInteral::MemberFunction<true, T, void, Args..., Args2...>::Type;
+	template<typename T, typename... Args2>
+	using NonConstMemberFunction = typename _DelegatesInteral::MemberFunction<false, T, void, Args..., Args2...>::Type;
+
+public:
+	constexpr InlineCompactMulticastDelegate() noexcept
+		: m_pListeners(nullptr)
+	{
+	}
+
+	~InlineCompactMulticastDelegate() noexcept
+	{
+		Release();
+	}
+
+	InlineCompactMulticastDelegate(const InlineCompactMulticastDelegate& other)
+		: m_pListeners(nullptr)
+	{
+		if (other.m_pListeners != nullptr)
+		{
+			GetOrCreate() = *other.m_pListeners;
+		}
+	}
+
+	InlineCompactMulticastDelegate& operator=(const InlineCompactMulticastDelegate& other)
+	{
+		if (this != &other)
+		{
+			if (other.m_pListeners != nullptr)
+			{
+				GetOrCreate() = *other.m_pListeners;
+			}
+			else
+			{
+				RemoveAll();
+			}
+		}
+		return *this;
+	}
+
+	//The listener block is handed over
+	InlineCompactMulticastDelegate(InlineCompactMulticastDelegate&& other) noexcept
+		: m_pListeners(other.m_pListeners)
+	{
+		other.m_pListeners = nullptr;
+	}
+
+	InlineCompactMulticastDelegate& operator=(InlineCompactMulticastDelegate&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Release();
+			m_pListeners = other.m_pListeners;
+			other.m_pListeners = nullptr;
+		}
+		return *this;
+	}
+
+	template<typename T>
+	DelegateHandle operator+=(T&& l)
+	{
+		return GetOrCreate() += std::forward<T>(l);
+	}
+
+	//Add delegate with the += operator
+	DelegateHandle operator+=(DelegateT&& handler) noexcept
+	{
+		return Add(std::forward<DelegateT>(handler));
+	}
+
+	//Remove a delegate using its DelegateHandle
+	bool operator-=(DelegateHandle& handle)
+	{
+		return Remove(handle);
+	}
+
+	DelegateHandle Add(DelegateT&& handler) noexcept
+	{
+		return GetOrCreate().Add(std::move(handler));
+	}
+
+	//Add a delegate that is executed before the delegates with a lower priority, see InlineMulticastDelegate::Add
+	DelegateHandle Add(DelegateT&& handler, int priority) noexcept
+	{
+		return GetOrCreate().Add(std::move(handler), priority);
+	}
+
+	bool SetPriority(const DelegateHandle& handle, int priority)
+	{
+		return m_pListeners != nullptr && m_pListeners->SetPriority(handle, priority);
+	}
+
+	int GetPriority(const DelegateHandle& handle) const
+	{
+		return m_pListeners != nullptr ? m_pListeners->GetPriority(handle) : 0;
+	}
+
+	//Bind a member function
+	template<typename T, typename... Args2>
+	DelegateHandle AddRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		return GetOrCreate().AddRaw(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	template<typename T, typename... Args2>
+	DelegateHandle AddRaw(T* pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		return GetOrCreate().AddRaw(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	//Bind a static/global function
+	template<typename... Args2>
+	DelegateHandle AddStatic(void(*pFunction)(Args..., Args2...), Args2&&... args)
+	{
+		return GetOrCreate().AddStatic(pFunction, std::forward<Args2>(args)...);
+	}
+
+	//Bind a lambda
+	template<typename LambdaType, typename... Args2>
+	DelegateHandle AddLambda(LambdaType&& lambda, Args2&&... args)
+	{
+		return GetOrCreate().AddLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...);
+	}
+
+	//Bind a member function with a shared_ptr object
+	template<typename T, typename... Args2>
+	DelegateHandle AddSP(std::shared_ptr<T> pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		return GetOrCreate().AddSP(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	template<typename T, typename... Args2>
+	DelegateHandle AddSP(std::shared_ptr<T> pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		return GetOrCreate().AddSP(pObject, pFunction, std::forward<Args2>(args)...);
+	}
+
+	//Removes all handles that are bound from a specific object
+	//Ignored when pObject is null
+	//Note: Only works on Raw and SP bindings
+	void RemoveObject(void* pObject)
+	{
+		if (m_pListeners != nullptr)
+		{
+			m_pListeners->RemoveObject(pObject);
+			ReleaseIfEmpty();
+		}
+	}
+
+	//Remove a function from the event list by the handle
+	bool Remove(DelegateHandle& handle)
+	{
+		if (m_pListeners != nullptr && m_pListeners->Remove(handle))
+		{
+			ReleaseIfEmpty();
+			return true;
+		}
+		return false;
+	}
+
+	bool IsBoundTo(const DelegateHandle& handle) const
+	{
+		return m_pListeners != nullptr && m_pListeners->IsBoundTo(handle);
+	}
+
+	//Remove all the functions bound to the delegate
+	void RemoveAll()
+	{
+		if (m_pListeners != nullptr)
+		{
+			m_pListeners->RemoveAll();
+			ReleaseIfEmpty();
+		}
+	}
+
+	//Remove the delegates that were removed while broadcasting, frees the listeners if none are left
+	void Compress(size_t maxSpace = 0)
+	{
+		if (m_pListeners != nullptr)
+		{
+			m_pListeners->Compress(maxSpace);
+			ReleaseIfEmpty();
+		}
+	}
+
+	//Execute all functions that are bound, only a null check if there are none
+	void Broadcast(_DelegatesInteral::ParameterType<Args>... args)
+	{
+		if (m_pListeners != nullptr)
+		{
+			m_pListeners->Broadcast(args...);
+			if (m_pListeners != nullptr)
+			{
+				//Delegates can remove themselves or be expired
+				ReleaseIfEmpty();
+			}
+		}
+	}
+
+	size_t GetSize() const
+	{
+		return m_pListeners != nullptr ? m_pListeners->GetSize() : 0;
+	}
+
+	//Returns nullptr if nothing was added since the listeners were freed
+	MulticastT* GetListeners()
+	{
+		return m_pListeners;
+	}
+
+	const MulticastT* GetListeners() const
+	{
+		return m_pListeners;
+	}
+
+private:
+	MulticastT& GetOrCreate()
+	{
+		if (m_pListeners == nullptr)
+		{
+			m_pListeners = new (_DelegatesInteral::Alloc(sizeof(MulticastT))) MulticastT();
+		}
+		return *m_pListeners;
+	}
+
+	//A delegate that is broadcasting still counts the delegates it removed, so this never frees a broadcasting multicast
+	void ReleaseIfEmpty()
+	{
+		if (m_pListeners->GetSize() == 0)
+		{
+			Release();
+		}
+	}
+
+	void Release()
+	{
+		if (m_pListeners != nullptr)
+		{
+			m_pListeners->~MulticastT();
+			_DelegatesInteral::Free(m_pListeners);
+			m_pListeners = nullptr;
+		}
+	}
+
+	MulticastT* m_pListeners;
+};
+
+template<typename... Args>
+using CompactMulticastDelegate = InlineCompactMulticastDelegate<DELEGATE_INLINE_ALLOCATION_SIZE, Args...>;
+
+//Delegate with a return value that can be bound to by MULTIPLE objects
+//Broadcast aggregates the results with a combiner, see Delegates::First, Last, Sum, Min, Max, AllOf and WriteToSpan.
+//Delegates are executed in the order they were added, unless a priority was given.
+//Use the MulticastDelegateRet alias for the default size (DELEGATE_INLINE_ALLOCATION_SIZE)
+template<size_t InlineSize, typename RetVal, typename... Args>
+class InlineMulticastDelegateRet : public MulticastDelegateBase<InlineSize, RetVal, Args...>
+{
+	static_assert(!std::is_void<RetVal>::value && !std::is_reference<RetVal>::value, "Use MulticastDelegate for delegates without a return value, references can't be aggregated");
+
+	using Base = MulticastDelegateBase<InlineSize, RetVal, Args...>;
+
+public:
+	using DelegateT = typename Base::DelegateT;
+
+private:
+	using InvokeRecord = typename Base::InvokeRecord;
+	//Combiner for a Broadcast without aggregation
+	struct IgnoreResults
+	{
+		using ResultType = void;
+		bool Add(RetVal&&) { return true; }
+		void GetResult() const {}
+	};
+
+public:
+	//Default constructor
+	//Removing keeps the order of the other delegates because the combiners depend on it
+	InlineMulticastDelegateRet()
+	{
+		this->m_Ordered = true;
+	}
+
+#if DELEGATE_PMR
+	//The listener arrays are allocated from the memory resource, see InlineMulticastDelegate
+	explicit InlineMulticastDelegateRet(std::pmr::memory_resource* pResource)
+		: Base(pResource)
+	{
+		this->m_Ordered = true;
+	}
+#endif
+
+	//Execute all functions that are bound and ignore the results
+	void Broadcast(_DelegatesInteral::ParameterType<Args>... args)
+	{
+		IgnoreResults combiner;
+		Broadcast(combiner, args...);
+	}
+
+	//Execute all functions that are bound and aggregate the results with a default constructed combiner
+	//multicast.Broadcast<Delegates::Sum<float>>(query);
+	template<typename CombinerT>
+	typename CombinerT::ResultType Broadcast(_DelegatesInteral::ParameterType<Args>... args)
+	{
+		CombinerT combiner;
+		return Broadcast(combiner, args...);
+	}
+
+	//Execute all functions that are bound and aggregate the results with the combiner
+	//Stops when the combiner returns false. Delegates bound to a std::shared_ptr that expired are skipped and removed
+	template<typename CombinerT>
+	typename CombinerT::ResultType Broadcast(CombinerT& combiner, _DelegatesInteral::ParameterType<Args>... args)
+	{
+		this->Lock();
+		for (size_t i = 0; i < this->m_Invokers.size(); ++i)
+		{
+			//Copy, a delegate can add delegates and reallocate the array
+			InvokeRecord record = this->m_Invokers[i];
+			if (record.pInvoker != nullptr)
+			{
+				//A single call checks if the bound object is alive and executes it
+				bool isAlive = true;
+				RetVal result = record.pInvoker(record.pDelegate, isAlive, Args(args)...);
+				if (isAlive == false)
+				{
+					//Only invalidated while broadcasting, removed by Compress() in Unlock()
+					this->RemoveAt(i);
+				}
+				else if (combiner.Add(std::move(result)) == false)
+				{
+					break;
+				}
+			}
+		}
+		this->Unlock();
+		return combiner.GetResult();
+	}
+};
+
+template<typename RetVal, typename... Args>
+using MulticastDelegateRet = InlineMulticastDelegateRet<DELEGATE_INLINE_ALLOCATION_SIZE, RetVal, Args...>;
+
+//Multicast delegate with a fixed list of global/static functions known at compile time
+//Broadcast calls the functions directly in order: no array, no handles and no indirect calls so they can be inlined.
+//StaticMulticastDelegate<void(*)(int), &OnFirst, &OnSecond>::Broadcast(10);
+//Broadcast is a function pointer itself so it can be added to a MulticastDelegate as a whole with AddStatic
+template<typename FunctionT, FunctionT... Functions>
+class StaticMulticastDelegate;
+
+template<typename... Args, void(*... Functions)(Args...)>
+class StaticMulticastDelegate<void(*)(Args...), Functions...>
+{
+public:
+	//Execute all functions in the order they are listed
+	//Large arguments are taken by reference, each function receives its own copy
+	static void Broadcast(_DelegatesInteral::ParameterType<Args>... args)
+	{
+		using Expander = int[];
+		(void)Expander{ 0, (Functions(Args(args)...), 0)... };
+	}
+
+	void operator()(_DelegatesInteral::ParameterType<Args>... args) const
+	{
+		Broadcast(args...);
+	}
+
+	static constexpr size_t GetSize()
+	{
+		return sizeof...(Functions);
+	}
+};
+
+#if DELEGATE_AUTO_TEMPLATE
+//StaticMulticast<&OnFirst, &OnSecond>::Broadcast(10);
+template<auto Function, decltype(Function)... Functions>
+using StaticMulticast = StaticMulticastDelegate<decltype(Function), Function, Functions...>;
+#endif
+
+//Delegate that can be bound to by MULTIPLE objects and broadcast from multiple threads at once
+//Broadcast reads an immutable, refcounted snapshot of the listeners and never blocks.
+//Add/Remove build a new snapshot and publish it atomically. Writers are serialized with a mutex.
+//Old snapshots are destroyed by whoever releases the last reference to it,
+//so a broadcast that started before a Remove can still call the removed listener.
+//Listeners themselves must be safe to execute from multiple threads.
+template<typename... Args>
+class ConcurrentMulticastDelegate
+{
+public:
+	using DelegateT = Delegate<void, Args...>;
+
+private:
+	struct DelegateHandlerPair
+	{
+		DelegateHandle Handle;
+		DelegateT Callback;
+		DelegateHandlerPair(const DelegateHandle& handle, const DelegateT& callback) : Handle(handle), Callback(callback) {}
+		DelegateHandlerPair(const DelegateHandle& handle, DelegateT&& callback) : Handle(handle), Callback(std::move(callback)) {}
+	};
+
+	//Immutable list of listeners
+	struct Snapshot
+	{
+		Snapshot() : RefCount(1) {}
+		std::atomic<unsigned int> RefCount;
+		std::vector<DelegateHandlerPair> Events;
+	};
+
+	template<typename T, typename... Args2>
+	using ConstMemberFunction = typename _DelegatesInteral::MemberFunction<true, T, void, Args..., Args2...>::Type;
+	template<typename T, typename... Args2>
+	using NonConstMemberFunction = typename _DelegatesInteral::MemberFunction<false, T, void, Args..., Args2...>::Type;
+
+public:
+	//Default constructor
+	ConcurrentMulticastDelegate()
+		: m_pSnapshot(nullptr), m_Epoch(0)
+	{
+		m_Readers[0] = 0;
+		m_Readers[1] = 0;
+	}
+
+	//Destructor
+	//No thread may be broadcasting while the delegate is destroyed
+	~ConcurrentMulticastDelegate() noexcept
+	{
+		Release(m_pSnapshot.load());
+	}
+
+	ConcurrentMulticastDelegate(const ConcurrentMulticastDelegate& other) = delete;
+	ConcurrentMulticastDelegate& operator=(const ConcurrentMulticastDelegate& other) = delete;
+
+	template<typename T>
+	DelegateHandle operator+=(T&& l)
+	{
+		return Add(DelegateT::CreateLambda(std::move(l)));
+	}
+
+	//Add delegate with the += operator
+	DelegateHandle operator+=(DelegateT&& handler)
+	{
+		return Add(std::forward<DelegateT>(handler));
+	}
+
+	//Remove a delegate using its DelegateHandle
+	bool operator-=(DelegateHandle& handle)
+	{
+		return Remove(handle);
+	}
+
+	DelegateHandle Add(DelegateT&& handler)
+	{
+		std::lock_guard<std::mutex> lock(m_WriteLock);
+		Snapshot* pSnapshot = CopySnapshot(1);
+		pSnapshot->Events.emplace_back(DelegateHandle(true), std::move(handler));
+		DelegateHandle handle = pSnapshot->Events.back().Handle;
+		Publish(pSnapshot);
+		return handle;
+	}
+
+	//Bind a member function
+	template<typename T, typename... Args2>
+	DelegateHandle AddRaw(T* pObject, NonConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		return Add(DelegateT::CreateRaw(pObject, pFunction, std::forward<Args2>(args)...));
+	}
+
+	template<typename T, typename... Args2>
+	DelegateHandle AddRaw(T* pObject, ConstMemberFunction<T, Args2...> pFunction, Args2&&... args)
+	{
+		return Add(DelegateT::CreateRaw(pObject, pFunction, std::forward<Args2>(args)...));
+	}
+
+	//Bind a static/global function
+	template<typename... Args2>
+	DelegateHandle AddStatic(void(*pFunction)(Args..., Args2...), Args2&&... args)
+	{
+		return Add(DelegateT::CreateStatic(pFunction, std::forward<Args2>(args)...));
+	}
+
+	//Bind a lambda
+	template<typename LambdaType, typename... Args2>
+	DelegateHandle AddLambda(LambdaType&& lambda, Args2&&... args)
+	{
+		return Add(DelegateT::CreateLambda(std::forward<LambdaType>(lambda), std::forward<Args2>(args)...));
 	}
 
 	//Bind a member function with a shared_ptr object
@@ -957,20 +4279,27 @@ public:
 	{
 		if (pObject != nullptr)
 		{
-			for (size_t i = 0; i < m_Events.size(); ++i)
+			std::lock_guard<std::mutex> lock(m_WriteLock);
+			Snapshot* pCurrent = m_pSnapshot.load();
+			if (pCurrent != nullptr)
 			{
-				if (m_Events[i].Callback.GetOwner() == pObject)
+				Snapshot* pSnapshot = CreateSnapshot();
+				pSnapshot->Events.reserve(pCurrent->Events.size());
+				for (const DelegateHandlerPair& handler : pCurrent->Events)
 				{
-					if (IsLocked())
-					{
-						m_Events[i].Callback.Clear();
-					}
-					else
+					if (handler.Callback.GetOwner() != pObject)
 					{
-						std::swap(m_Events[i], m_Events[m_Events.size() - 1]);
-						m_Events.pop_back();
+						pSnapshot->Events.push_back(handler);
 					}
 				}
+				if (pSnapshot->Events.size() != pCurrent->Events.size())
+				{
+					Publish(pSnapshot);
+				}
+				else
+				{
+					Release(pSnapshot);
+				}
 			}
 		}
 	}
@@ -980,21 +4309,22 @@ public:
 	{
 		if (handle.IsValid())
 		{
-			for (size_t i = 0; i < m_Events.size(); ++i)
+			std::lock_guard<std::mutex> lock(m_WriteLock);
+			Snapshot* pCurrent = m_pSnapshot.load();
+			if (pCurrent != nullptr)
 			{
-				if (m_Events[i].Handle == handle)
+				for (size_t i = 0; i < pCurrent->Events.size(); ++i)
 				{
-					if (IsLocked())
-					{
-						m_Events[i].Callback.Clear();
-					}
-					else
+					if (pCurrent->Events[i].Handle == handle)
 					{
-						std::swap(m_Events[i], m_Events[m_Events.size() - 1]);
-						m_Events.pop_back();
+						Snapshot* pSnapshot = CreateSnapshot();
+						pSnapshot->Events.reserve(pCurrent->Events.size() - 1);
+						pSnapshot->Events.insert(pSnapshot->Events.end(), pCurrent->Events.begin(), pCurrent->Events.begin() + i);
+						pSnapshot->Events.insert(pSnapshot->Events.end(), pCurrent->Events.begin() + i + 1, pCurrent->Events.end());
+						Publish(pSnapshot);
+						handle.Reset();
+						return true;
 					}
-					handle.Reset();
-					return true;
 				}
 			}
 		}
@@ -1003,96 +4333,358 @@ public:
 
 	bool IsBoundTo(const DelegateHandle& handle) const
 	{
+		bool found = false;
 		if (handle.IsValid())
 		{
-			for (size_t i = 0; i < m_Events.size(); ++i)
+			Snapshot* pSnapshot = Acquire();
+			if (pSnapshot != nullptr)
 			{
-				if (m_Events[i].Handle == handle)
+				for (const DelegateHandlerPair& handler : pSnapshot->Events)
 				{
-					return true;
+					if (handler.Handle == handle)
+					{
+						found = true;
+						break;
+					}
 				}
+				Release(pSnapshot);
 			}
 		}
-		return false;
+		return found;
 	}
 
 	//Remove all the functions bound to the delegate
 	void RemoveAll()
 	{
-		if (IsLocked())
+		std::lock_guard<std::mutex> lock(m_WriteLock);
+		if (m_pSnapshot.load() != nullptr)
+		{
+			Publish(nullptr);
+		}
+	}
+
+	//Execute all functions that are bound
+	//Safe to call from any number of threads, also while other threads Add or Remove
+	void Broadcast(_DelegatesInteral::ParameterType<Args>... args) const
+	{
+		Snapshot* pSnapshot = Acquire();
+		if (pSnapshot != nullptr)
 		{
-			for (DelegateHandlerPair& handler : m_Events)
+			for (const DelegateHandlerPair& handler : pSnapshot->Events)
 			{
-				handler.Callback.Clear();
+				handler.Callback.Execute(args...);
 			}
+			Release(pSnapshot);
 		}
-		else
+	}
+
+	size_t GetSize() const
+	{
+		size_t size = 0;
+		Snapshot* pSnapshot = Acquire();
+		if (pSnapshot != nullptr)
 		{
-			m_Events.clear();
+			size = pSnapshot->Events.size();
+			Release(pSnapshot);
 		}
+		return size;
 	}
 
-	void Compress(size_t maxSpace = 0)
+private:
+	//Take a reference to the current snapshot.
+	//The reader counter of the current epoch guards the window between loading the pointer
+	//and incrementing the refcount, so a writer can't drop the last reference in between.
+	//The epoch is checked again after registering: a reader that registers in an epoch that already ended
+	//isn't waited for by the writers and has to try again.
+	Snapshot* Acquire() const
 	{
-		if (IsLocked() == false)
+		for (;;)
 		{
-			size_t toDelete = 0;
-			for (size_t i = 0; i < m_Events.size() - toDelete; ++i)
+			const unsigned int epoch = m_Epoch.load();
+			std::atomic<unsigned int>& readers = m_Readers[epoch & 1];
+			readers.fetch_add(1);
+			if (m_Epoch.load() == epoch)
 			{
-				if (m_Events[i].Handle.IsValid() == false)
+				Snapshot* pSnapshot = m_pSnapshot.load();
+				if (pSnapshot != nullptr)
 				{
-					std::swap(m_Events[i], m_Events[toDelete]);
-					++toDelete;
+					pSnapshot->RefCount.fetch_add(1, std::memory_order_relaxed);
 				}
+				readers.fetch_sub(1);
+				return pSnapshot;
 			}
-			if (toDelete > maxSpace)
-			{
-				m_Events.resize(m_Events.size() - toDelete);
-			}
+			readers.fetch_sub(1);
 		}
 	}
 
-	//Execute all functions that are bound
-	void Broadcast(Args... args)
+	static Snapshot* CreateSnapshot()
+	{
+		return new (_DelegatesInteral::Alloc(sizeof(Snapshot))) Snapshot();
+	}
+
+	static void Release(Snapshot* pSnapshot)
 	{
-		Lock();
-		for (size_t i = 0; i < m_Events.size(); ++i)
+		if (pSnapshot != nullptr && pSnapshot->RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
 		{
-			if (m_Events[i].Handle.IsValid())
-			{
-				m_Events[i].Callback.Execute(args...);
-			}
+			pSnapshot->~Snapshot();
+			_DelegatesInteral::Free(pSnapshot);
+		}
+	}
+
+	//Copy the current listeners into a new snapshot. Must hold m_WriteLock
+	Snapshot* CopySnapshot(size_t extraCapacity) const
+	{
+		Snapshot* pSnapshot = CreateSnapshot();
+		Snapshot* pCurrent = m_pSnapshot.load();
+		if (pCurrent != nullptr)
+		{
+			pSnapshot->Events.reserve(pCurrent->Events.size() + extraCapacity);
+			pSnapshot->Events.insert(pSnapshot->Events.end(), pCurrent->Events.begin(), pCurrent->Events.end());
+		}
+		return pSnapshot;
+	}
+
+	//Swap in the new snapshot and drop the reference of the delegate to the old one. Must hold m_WriteLock
+	//Readers that are still in their acquire window of the previous epoch are waited for.
+	//Readers of older epochs were waited for by the previous writers, or see the epoch changed and retry.
+	//Readers that already hold a reference keep the old snapshot alive until they're done with it.
+	void Publish(Snapshot* pSnapshot)
+	{
+		Snapshot* pOld = m_pSnapshot.exchange(pSnapshot);
+		unsigned int epoch = m_Epoch.fetch_add(1);
+		while (m_Readers[epoch & 1].load() != 0)
+		{
+			std::this_thread::yield();
 		}
-		Unlock();
+		Release(pOld);
+	}
+
+	std::atomic<Snapshot*> m_pSnapshot;
+	std::atomic<unsigned int> m_Epoch;
+	mutable std::atomic<unsigned int> m_Readers[2];
+	std::mutex m_WriteLock;
+};
+
+//Records broadcasts of multicast delegates to run them later with Flush
+//The arguments are constructed in place in pages of memory that are reused, so queueing doesn't allocate once warmed up.
+//Events queued while flushing are kept for the next Flush.
+//The multicast delegates must outlive their queued events or be discarded with Discard.
+//Not thread safe. Implementation of the non-template functions is in Delegates.cpp
+class EventQueue
+{
+public:
+	explicit EventQueue(size_t pageSize = 4096);
+	~EventQueue() noexcept;
+
+	EventQueue(const EventQueue& other) = delete;
+	EventQueue& operator=(const EventQueue& other) = delete;
+
+	//Queue a Broadcast of the multicast delegate with the given arguments
+	//The arguments are copied (or moved), references are not kept
+	template<size_t InlineSize, typename... Args, typename... Args2>
+	void Enqueue(InlineMulticastDelegate<InlineSize, Args...>& multicast, Args2&&... args)
+	{
+		using ArgumentsT = std::tuple<typename std::decay<Args>::type...>;
+		static_assert(alignof(ArgumentsT) <= Alignment, "Event arguments are over-aligned");
+		EventHeader* pEvent = ReserveEvent(sizeof(ArgumentsT));
+		pEvent->pDispatch = &Dispatch<InlineMulticastDelegate<InlineSize, Args...>, Args...>;
+		pEvent->pTarget = &multicast;
+		//Only queued once the arguments are constructed, nothing is left behind if that throws
+		new (GetArguments(pEvent)) ArgumentsT(std::forward<Args2>(args)...);
+		CommitEvent(pEvent);
+	}
+
+	//Broadcast all queued events in the order they were queued
+	void Flush();
+
+	//Broadcast all queued events, the events of the same multicast delegate together
+	//Events of a multicast delegate keep their order
+	void FlushGrouped();
+
+	//Drop all queued events without broadcasting them
+	void Clear();
+
+	//Drop the queued events of the multicast delegate, for example before it is destroyed
+	template<size_t InlineSize, typename... Args>
+	void Discard(const InlineMulticastDelegate<InlineSize, Args...>& multicast)
+	{
+		Discard(static_cast<const void*>(&multicast));
 	}
 
+	//Amount of queued events
 	size_t GetSize() const
 	{
-		return m_Events.size();
+		return m_Count;
+	}
+
+	bool IsEmpty() const
+	{
+		return m_Count == 0;
 	}
 
 private:
-	void Lock()
+	struct EventHeader;
+	struct Page;
+	struct FlushScope;
+
+	//Broadcasts the event if broadcast is true and destroys the arguments
+	using DispatchFunction = void(*)(EventHeader* pEvent, bool broadcast);
+
+	struct EventHeader
 	{
-		++m_Locks;
+		DispatchFunction pDispatch;
+		//nullptr when discarded
+		void* pTarget;
+		//Size of the event including the header and padding
+		size_t Size;
+	};
+
+	enum : size_t
+	{
+		Alignment = 16,
+		HeaderSize = (sizeof(EventHeader) + Alignment - 1) & ~(Alignment - 1),
+	};
+
+	static void* GetArguments(EventHeader* pEvent)
+	{
+		return reinterpret_cast<char*>(pEvent) + HeaderSize;
 	}
 
-	void Unlock()
+	template<typename MulticastT, typename... Args>
+	static void Dispatch(EventHeader* pEvent, bool broadcast)
 	{
-		//Unlock() should never be called more than Lock()!
-		DELEGATE_ASSERT(m_Locks > 0);
-		--m_Locks;
+		using ArgumentsT = std::tuple<typename std::decay<Args>::type...>;
+		ArgumentsT* pArguments = static_cast<ArgumentsT*>(GetArguments(pEvent));
+		if (broadcast && pEvent->pTarget != nullptr)
+		{
+			Broadcast<Args...>(*static_cast<MulticastT*>(pEvent->pTarget), *pArguments, std::index_sequence_for<Args...>());
+		}
+		pArguments->~ArgumentsT();
 	}
 
-	//Returns true is the delegate is currently broadcasting
-	//If this is true, the order of the array should not be changed otherwise this causes undefined behaviour
-	bool IsLocked() const
+	template<typename... Args, typename MulticastT, typename ArgumentsT, size_t... Is>
+	static void Broadcast(MulticastT& multicast, ArgumentsT& arguments, std::index_sequence<Is...>)
 	{
-		return m_Locks > 0;
+		(void)arguments;
+		multicast.Broadcast(std::forward<Args>(std::get<Is>(arguments))...);
 	}
 
-	std::vector<DelegateHandlerPair> m_Events;
-	unsigned int m_Locks;
+	//Space for the event at the end of the last page, not part of the queue until CommitEvent
+	EventHeader* ReserveEvent(size_t argumentsSize);
+	void CommitEvent(EventHeader* pEvent);
+	void Discard(const void* pTarget);
+	void ReleasePages(std::vector<Page*>& pages);
+
+	//Pages with queued events in order
+	std::vector<Page*> m_Pages;
+	//Empty pages to reuse
+	std::vector<Page*> m_FreePages;
+	//Pages of the innermost Flush in progress, nullptr when not flushing
+	//A listener can Flush again, the scopes link to the pages of the flushes around them.
+	FlushScope* m_pFlushing;
+	size_t m_PageSize;
+	size_t m_Count;
+};
+
+//Runs delegates posted from any thread on the thread that owns the dispatcher
+//Posting is lock-free (a single atomic exchange). The delegate and its arguments are stored in one queue node
+//allocated from the SlabAllocator so small closures don't hit the heap.
+//The owner thread runs the queued delegates in the order they were posted with Dispatch.
+//Implementation of the non-template functions is in Delegates.cpp
+class DelegateDispatcher
+{
+public:
+	//The thread creating the dispatcher owns it
+	DelegateDispatcher();
+	//Pending delegates are dropped without running them. Nothing may be posted anymore at this point
+	~DelegateDispatcher() noexcept;
+
+	DelegateDispatcher(const DelegateDispatcher& other) = delete;
+	DelegateDispatcher& operator=(const DelegateDispatcher& other) = delete;
+
+	//Queue the delegate to run on the owner thread with the given arguments. Can be called from any thread
+	//The arguments are copied (or moved), references are not kept
+	template<size_t InlineSize, typename... Args, typename... Args2>
+	void Post(const InlineDelegate<InlineSize, void, Args...>& callback, Args2&&... args)
+	{
+		using CallT = DispatchCall<InlineDelegate<InlineSize, void, Args...>, Args...>;
+		void* pMemory = Delegates::SlabAllocator::Allocate(sizeof(CallT));
+		Push(new (pMemory) CallT(callback, std::forward<Args2>(args)...));
+	}
+
+	template<size_t InlineSize, typename... Args, typename... Args2>
+	void Post(InlineDelegate<InlineSize, void, Args...>&& callback, Args2&&... args)
+	{
+		using CallT = DispatchCall<InlineDelegate<InlineSize, void, Args...>, Args...>;
+		void* pMemory = Delegates::SlabAllocator::Allocate(sizeof(CallT));
+		Push(new (pMemory) CallT(std::move(callback), std::forward<Args2>(args)...));
+	}
+
+	template<typename TLambda, typename... Args2>
+	void PostLambda(TLambda&& lambda, Args2&&... args)
+	{
+		Post(Delegate<void>::CreateLambda(std::forward<TLambda>(lambda), std::forward<Args2>(args)...));
+	}
+
+	//Run the delegates that were posted before the call, returns the amount that ran
+	//Delegates posted while dispatching run on the next Dispatch. Only call this on the owner thread
+	size_t Dispatch();
+
+	bool IsOwnerThread() const
+	{
+		return std::this_thread::get_id() == m_Owner;
+	}
+
+private:
+	struct Node
+	{
+		std::atomic<Node*> pNext;
+		//Runs the delegate if execute is true and destroys the node
+		void(*pFunction)(Node* pNode, bool execute);
+	};
+
+	template<typename DelegateT, typename... Args>
+	struct DispatchCall : Node
+	{
+		template<typename DelegateT2, typename... Args2>
+		DispatchCall(DelegateT2&& callback, Args2&&... args)
+			: Callback(std::forward<DelegateT2>(callback)), Arguments(std::forward<Args2>(args)...)
+		{
+			this->pFunction = &Run;
+		}
+
+		static void Run(Node* pNode, bool execute)
+		{
+			DispatchCall* pCall = static_cast<DispatchCall*>(pNode);
+			if (execute)
+			{
+				pCall->Invoke(std::index_sequence_for<Args...>());
+			}
+			pCall->~DispatchCall();
+			Delegates::SlabAllocator::Free(pCall);
+		}
+
+		template<size_t... Is>
+		void Invoke(std::index_sequence<Is...>)
+		{
+			Callback.ExecuteIfBound(std::forward<Args>(std::get<Is>(Arguments))...);
+		}
+
+		DelegateT Callback;
+		std::tuple<typename std::decay<Args>::type...> Arguments;
+	};
+
+	void Push(Node* pNode);
+	//Returns nullptr when the queue is empty or the next node is still being pushed
+	Node* Pop();
+
+	//Last posted node, producers exchange it
+	std::atomic<Node*> m_pHead;
+	//Next node to dispatch, only touched by the owner thread
+	Node* m_pTail;
+	//Placeholder that keeps the queue from ever being empty
+	Node m_Stub;
+	std::thread::id m_Owner;
 };
 
 #endif
@@ -2,6 +2,10 @@
 #include "Delegates.h"
 #include <memory>
 #include <array>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
 
 #define CATCH_CONFIG_RUNNER
 #define CATCH_CONFIG_NO_WCHAR
@@ -315,6 +319,17 @@ TEST_CASE("Multicast Delegate", "Simple")
 		REQUIRE(values[10] == 0);
 	}
 
+	SECTION("Delegate")
+	{
+		testDelegate.Add(TestDelegate::CreateLambda([&values](int a)
+			{
+				values[a] = a;
+			}));
+		REQUIRE(values[10] == 0);
+		testDelegate.Broadcast(10);
+		REQUIRE(values[10] == 10);
+	}
+
 	SECTION("Raw")
 	{
 		struct Foo
@@ -406,6 +421,19 @@ TEST_CASE("Multicast Delegate Removes", "Simple")
 		REQUIRE(values[10] == 10);
 	}
 
+	SECTION("Delegate Handle")
+	{
+		DelegateHandle handle = testDelegate.Add(TestDelegate::CreateLambda([&values](int a)
+			{
+				values[a] = a;
+			}));
+		testDelegate.Broadcast(10);
+		REQUIRE(values[10] == 10);
+		REQUIRE(testDelegate.Remove(handle));
+		testDelegate.Broadcast(20);
+		REQUIRE(values[20] == 0);
+	}
+
 	SECTION("Raw")
 	{
 		struct Foo
@@ -446,6 +474,12 @@ TEST_CASE("Multicase Delegate Inits", "Delegate Constructor/Copying/Moving")
 		REQUIRE(testDelegate.GetSize() == 3);
 	}
 
+	SECTION("Add Delegate")
+	{
+		testDelegate.Add(TestDelegateDelegate::CreateLambda([]() {}));
+		REQUIRE(testDelegate.GetSize() == 1);
+	}
+
 	SECTION("Copy Constructor")
 	{
 		testDelegate.AddLambda([]() {});
@@ -488,6 +522,2120 @@ TEST_CASE("Multicase Delegate Inits", "Delegate Constructor/Copying/Moving")
 	}
 }
 
+TEST_CASE("Delegate Invoker", "Execute after copying/moving")
+{
+	DECLARE_DELEGATE_RET(TestDelegate, float, float);
+	Foo foo;
+
+	SECTION("Copy")
+	{
+		TestDelegate del = TestDelegate::CreateRaw(&foo, &Foo::Bar);
+		TestDelegate del2 = del;
+		REQUIRE(del.Execute(10) == 10);
+		REQUIRE(del2.Execute(20) == 20);
+	}
+
+	SECTION("Move")
+	{
+		TestDelegate del = TestDelegate::CreateLambda([](float a, float payload) { return a + payload; }, 5.0f);
+		TestDelegate del2 = std::move(del);
+		REQUIRE(del2.Execute(10) == 15);
+		REQUIRE(del.ExecuteIfBound(10) == 0);
+	}
+
+	SECTION("Rebind")
+	{
+		TestDelegate del = TestDelegate::CreateStatic(&Foo::BarStatic);
+		REQUIRE(del.Execute(10) == 10);
+		del.BindLambda([](float a) { return a * 2; });
+		REQUIRE(del.Execute(10) == 20);
+	}
+}
+
+TEST_CASE("Concurrent Multicast Delegate", "Simple")
+{
+	DECLARE_CONCURRENT_MULTICAST_DELEGATE(Test, int);
+	Test testDelegate;
+
+	using ValueArray = std::array<int, 64>;
+	ValueArray values{};
+
+	SECTION("Add/Remove")
+	{
+		DelegateHandle handle = testDelegate.Add(TestDelegate::CreateLambda([&values](int a)
+			{
+				values[a] = a;
+			}));
+		REQUIRE(testDelegate.GetSize() == 1);
+		REQUIRE(testDelegate.IsBoundTo(handle));
+		testDelegate.Broadcast(10);
+		REQUIRE(values[10] == 10);
+		REQUIRE(testDelegate.Remove(handle));
+		REQUIRE_FALSE(handle.IsValid());
+		testDelegate.Broadcast(20);
+		REQUIRE(values[20] == 0);
+		REQUIRE(testDelegate.GetSize() == 0);
+	}
+
+	SECTION("Remove Object")
+	{
+		struct Foo
+		{
+			Foo(ValueArray& v) : Values(v) {}
+			void Bar(int a)
+			{
+				Values[a] = a;
+			}
+			ValueArray& Values;
+		};
+		Foo foo(values);
+		testDelegate.AddRaw(&foo, &Foo::Bar);
+		testDelegate.AddLambda([](int) {});
+		testDelegate.RemoveObject(&foo);
+		REQUIRE(testDelegate.GetSize() == 1);
+		testDelegate.Broadcast(10);
+		REQUIRE(values[10] == 0);
+	}
+
+	SECTION("Broadcast from multiple threads")
+	{
+		std::atomic<int> calls(0);
+		std::atomic<bool> done(false);
+		testDelegate.AddLambda([&calls](int a) { calls += a; });
+
+		std::vector<std::thread> threads;
+		for (int i = 0; i < 4; ++i)
+		{
+			threads.emplace_back([&]()
+				{
+					do
+					{
+						testDelegate.Broadcast(1);
+					} while (!done);
+				});
+		}
+		for (int i = 0; i < 1000; ++i)
+		{
+			DelegateHandle handle = testDelegate.AddLambda([&calls](int a) { calls += a; });
+			testDelegate.Remove(handle);
+		}
+		done = true;
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		REQUIRE(testDelegate.GetSize() == 1);
+		REQUIRE(calls > 0);
+	}
+
+	SECTION("Multiple writers")
+	{
+		//Writers publish back to back so the epoch moves on while readers are acquiring
+		std::atomic<int> calls(0);
+		std::atomic<bool> done(false);
+		std::vector<std::thread> readers;
+		for (int i = 0; i < 4; ++i)
+		{
+			readers.emplace_back([&]()
+				{
+					do
+					{
+						testDelegate.Broadcast(1);
+						testDelegate.GetSize();
+					} while (!done);
+				});
+		}
+		std::vector<std::thread> writers;
+		for (int i = 0; i < 4; ++i)
+		{
+			writers.emplace_back([&]()
+				{
+					for (int j = 0; j < 2000; ++j)
+					{
+						DelegateHandle handle = testDelegate.AddLambda([&calls](int a) { calls += a; });
+						testDelegate.Remove(handle);
+					}
+				});
+		}
+		for (std::thread& thread : writers)
+		{
+			thread.join();
+		}
+		done = true;
+		for (std::thread& thread : readers)
+		{
+			thread.join();
+		}
+		REQUIRE(testDelegate.GetSize() == 0);
+	}
+}
+
+TEST_CASE("Delegate Handle", "Unique IDs across threads")
+{
+	const size_t handlesPerThread = 3 * DelegateHandle::ID_BLOCK_SIZE;
+	std::vector<std::vector<DelegateHandle>> handles(4);
+	std::vector<std::thread> threads;
+	for (std::vector<DelegateHandle>& threadHandles : handles)
+	{
+		threads.emplace_back([&threadHandles, handlesPerThread]()
+			{
+				for (size_t i = 0; i < handlesPerThread; ++i)
+				{
+					threadHandles.emplace_back(true);
+				}
+			});
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	std::vector<DelegateHandle> allHandles;
+	for (const std::vector<DelegateHandle>& threadHandles : handles)
+	{
+		allHandles.insert(allHandles.end(), threadHandles.begin(), threadHandles.end());
+	}
+	std::sort(allHandles.begin(), allHandles.end());
+	REQUIRE(std::adjacent_find(allHandles.begin(), allHandles.end()) == allHandles.end());
+	REQUIRE(std::all_of(allHandles.begin(), allHandles.end(), [](const DelegateHandle& handle) { return handle.IsValid(); }));
+}
+
+TEST_CASE("Multicast Delegate Handles", "Slots and stale handles")
+{
+	DECLARE_MULTICAST_DELEGATE(Test, int);
+	Test testDelegate;
+	int calls = 0;
+
+	SECTION("Stale Handle")
+	{
+		DelegateHandle handle = testDelegate.AddLambda([&calls](int) { ++calls; });
+		DelegateHandle staleHandle = handle;
+		REQUIRE(testDelegate.Remove(handle));
+		DelegateHandle newHandle = testDelegate.Add(TestDelegate::CreateLambda([&calls](int) { ++calls; }));
+		REQUIRE(newHandle.GetIndex() == staleHandle.GetIndex());
+		REQUIRE_FALSE(testDelegate.IsBoundTo(staleHandle));
+		REQUIRE_FALSE(testDelegate.Remove(staleHandle));
+		REQUIRE(testDelegate.IsBoundTo(newHandle));
+		testDelegate.Broadcast(0);
+		REQUIRE(calls == 1);
+	}
+
+	SECTION("Remove Many")
+	{
+		std::vector<DelegateHandle> handles;
+		for (int i = 0; i < 100; ++i)
+		{
+			handles.push_back(testDelegate.AddLambda([&calls](int) { ++calls; }));
+		}
+		for (size_t i = 0; i < handles.size(); i += 2)
+		{
+			REQUIRE(testDelegate.Remove(handles[i]));
+		}
+		REQUIRE(testDelegate.GetSize() == 50);
+		for (size_t i = 1; i < handles.size(); i += 2)
+		{
+			REQUIRE(testDelegate.IsBoundTo(handles[i]));
+		}
+		testDelegate.Broadcast(0);
+		REQUIRE(calls == 50);
+	}
+
+	SECTION("Reuse Slots")
+	{
+		std::vector<DelegateHandle> handles;
+		for (int i = 0; i < 100; ++i)
+		{
+			handles.push_back(testDelegate.AddLambda([&calls](int) { ++calls; }));
+		}
+		for (int i = 0; i < 3; ++i)
+		{
+			for (size_t j = 0; j < handles.size(); j += 3)
+			{
+				REQUIRE(testDelegate.Remove(handles[j]));
+				handles[j] = testDelegate.AddLambda([&calls](int) { ++calls; });
+			}
+		}
+		for (const DelegateHandle& handle : handles)
+		{
+			REQUIRE(handle.GetIndex() < 100);
+			REQUIRE(testDelegate.IsBoundTo(handle));
+		}
+		testDelegate.Broadcast(0);
+		REQUIRE(calls == 100);
+	}
+
+	SECTION("Remove While Broadcasting")
+	{
+		DelegateHandle handles[3];
+		handles[0] = testDelegate.AddLambda([&](int) { ++calls; testDelegate.Remove(handles[1]); });
+		handles[1] = testDelegate.AddLambda([&](int) { ++calls; testDelegate.Remove(handles[0]); });
+		handles[2] = testDelegate.AddLambda([&](int) { ++calls; });
+		testDelegate.Broadcast(0);
+		REQUIRE(calls == 2);
+		REQUIRE(testDelegate.GetSize() == 2);
+		REQUIRE_FALSE(handles[1].IsValid());
+		REQUIRE(testDelegate.IsBoundTo(handles[0]));
+		REQUIRE(testDelegate.IsBoundTo(handles[2]));
+	}
+}
+
+TEST_CASE("Delegate Relocation", "Moving inline delegates")
+{
+	DECLARE_DELEGATE_RET(TestDelegate, bool);
+
+	struct SelfReference
+	{
+		SelfReference() : pSelf(this) {}
+		SelfReference(const SelfReference&) : pSelf(this) {}
+		SelfReference(SelfReference&&) noexcept : pSelf(this) {}
+		SelfReference* pSelf;
+		bool IsValid() const { return pSelf == this; }
+	};
+
+	SECTION("Trivially Relocatable")
+	{
+		int value = 10;
+		auto lambda = [value]() { return value == 10; };
+		REQUIRE(LambdaDelegate<decltype(lambda), bool()>::IsTriviallyRelocatable);
+		REQUIRE(StaticDelegate<float(float), int>::IsTriviallyRelocatable);
+		REQUIRE(RawDelegate<false, Foo, float(float)>::IsTriviallyRelocatable);
+
+		TestDelegate del = TestDelegate::CreateLambda(lambda);
+		TestDelegate del2 = std::move(del);
+		REQUIRE(del2.Execute());
+		REQUIRE_FALSE(del.IsBound());
+	}
+
+	SECTION("Self Reference")
+	{
+		SelfReference object;
+		auto lambda = [object]() { return object.IsValid(); };
+		REQUIRE_FALSE(LambdaDelegate<decltype(lambda), bool()>::IsTriviallyRelocatable);
+
+		TestDelegate del = TestDelegate::CreateLambda(lambda);
+		REQUIRE(del.Execute());
+		TestDelegate del2 = std::move(del);
+		REQUIRE(del2.Execute());
+		REQUIRE_FALSE(del.IsBound());
+		TestDelegate del3;
+		del3 = std::move(del2);
+		REQUIRE(del3.Execute());
+	}
+
+	SECTION("Payload")
+	{
+		DECLARE_DELEGATE_RET(StringDelegate, size_t);
+		REQUIRE_FALSE(SPDelegate<false, Foo, float(float)>::IsTriviallyRelocatable);
+
+		StringDelegate del = StringDelegate::CreateLambda([](std::string text) { return text.size(); }, std::string("Hello"));
+		std::vector<StringDelegate> delegates;
+		for (int i = 0; i < 32; ++i)
+		{
+			delegates.push_back(std::move(del));
+			del = delegates.back();
+		}
+		for (const StringDelegate& d : delegates)
+		{
+			REQUIRE(d.Execute() == 5);
+		}
+	}
+}
+
+namespace
+{
+	int g_Allocations = 0;
+	void* CountingAlloc(size_t size)
+	{
+		++g_Allocations;
+		return malloc(size);
+	}
+	void CountingFree(void* pPtr)
+	{
+		free(pPtr);
+	}
+}
+
+TEST_CASE("Inline Delegate", "Inline allocation size per type")
+{
+	Delegates::SetAllocationCallbacks(&CountingAlloc, &CountingFree);
+	g_Allocations = 0;
+	std::array<char, 40> data{};
+	data[0] = 10;
+
+	SECTION("Delegate")
+	{
+		InlineDelegate<64, int> del = InlineDelegate<64, int>::CreateLambda([data]() { return (int)data[0]; });
+		REQUIRE(g_Allocations == 0);
+		REQUIRE(del.Execute() == 10);
+
+		Delegate<int> defaultDel = Delegate<int>::CreateLambda([data]() { return (int)data[0]; });
+		REQUIRE(g_Allocations == 1);
+		REQUIRE(defaultDel.Execute() == 10);
+
+		REQUIRE(sizeof(InlineDelegate<16, int>) < sizeof(Delegate<int>));
+		InlineDelegate<16, int> smallDel = InlineDelegate<16, int>::CreateLambda([]() { return 5; });
+		REQUIRE(g_Allocations == 1);
+		REQUIRE(smallDel.Execute() == 5);
+	}
+
+	SECTION("Multicast Delegate")
+	{
+		int sum = 0;
+		InlineMulticastDelegate<64, int> multicast;
+		multicast.AddLambda([data, &sum](int a) { sum += data[0] + a; });
+		multicast.AddLambda([data, &sum](int a) { sum += data[0] + a; });
+		InlineMulticastDelegate<64, int> copy = multicast;
+		copy.Broadcast(1);
+		REQUIRE(g_Allocations == 0);
+		REQUIRE(sum == 22);
+	}
+
+	Delegates::SetAllocationCallbacks([](size_t size) { return malloc(size); }, [](void* pPtr) { free(pPtr); });
+}
+
+TEST_CASE("Slab Allocator", "Pool allocator for heap allocated delegates")
+{
+	SECTION("Allocations")
+	{
+		std::vector<void*> allocations;
+		for (size_t size = 1; size < 2 * Delegates::SlabAllocator::MaxBlockSize; size += 37)
+		{
+			void* pPtr = Delegates::SlabAllocator::Allocate(size);
+			REQUIRE(pPtr != nullptr);
+			REQUIRE(reinterpret_cast<uintptr_t>(pPtr) % 16 == 0);
+			memset(pPtr, 0xcd, size);
+			allocations.push_back(pPtr);
+		}
+		std::sort(allocations.begin(), allocations.end());
+		REQUIRE(std::adjacent_find(allocations.begin(), allocations.end()) == allocations.end());
+		for (void* pPtr : allocations)
+		{
+			Delegates::SlabAllocator::Free(pPtr);
+		}
+
+		void* pPtr = Delegates::SlabAllocator::Allocate(100);
+		Delegates::SlabAllocator::Free(pPtr);
+		REQUIRE(Delegates::SlabAllocator::Allocate(100) == pPtr);
+		Delegates::SlabAllocator::Free(pPtr);
+	}
+
+	SECTION("Free On Other Thread")
+	{
+		std::vector<void*> allocations;
+		for (int i = 0; i < 1000; ++i)
+		{
+			allocations.push_back(Delegates::SlabAllocator::Allocate(200));
+		}
+		std::thread thread([&allocations]()
+			{
+				for (void* pPtr : allocations)
+				{
+					Delegates::SlabAllocator::Free(pPtr);
+				}
+			});
+		thread.join();
+	}
+
+	SECTION("Delegates")
+	{
+		Delegates::SlabAllocator::Install();
+		std::array<float, 64> data{};
+		data[0] = 5;
+		DECLARE_DELEGATE_RET(TestDelegate, float, float);
+		TestDelegate del = TestDelegate::CreateLambda([data](float a) { return data[0] + a; });
+		std::vector<TestDelegate> copies(16, del);
+		for (const TestDelegate& copy : copies)
+		{
+			REQUIRE(copy.Execute(1) == 6);
+		}
+		copies.clear();
+		del.Clear();
+		Delegates::SetAllocationCallbacks([](size_t size) { return malloc(size); }, [](void* pPtr) { free(pPtr); });
+	}
+}
+
+#if DELEGATE_PMR
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	int Allocations = 0;
+	int Deallocations = 0;
+
+private:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		++Allocations;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override
+	{
+		++Deallocations;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+TEST_CASE("Memory Resource", "std::pmr support")
+{
+	CountingResource resource;
+	std::array<char, 128> data{};
+	data[0] = 3;
+
+	SECTION("Delegate")
+	{
+		DECLARE_DELEGATE_RET(TestDelegate, int);
+		TestDelegate del;
+		{
+			Delegates::ScopedMemoryResource scope(&resource);
+			del.BindLambda([data]() { return (int)data[0]; });
+		}
+		REQUIRE(resource.Allocations == 1);
+		TestDelegate copy = del;
+		REQUIRE(resource.Allocations == 1);
+		REQUIRE(del.Execute() == 3);
+		del.Clear();
+		REQUIRE(resource.Deallocations == 1);
+		REQUIRE(copy.Execute() == 3);
+	}
+
+	SECTION("Multicast Delegate")
+	{
+		{
+			int sum = 0;
+			MulticastDelegate<int> multicast(&resource);
+			for (int i = 0; i < 8; ++i)
+			{
+				multicast.AddLambda([data, &sum](int a) { sum += data[0] + a; });
+			}
+			multicast.AddLambda([&sum](int a) { sum += a; });
+			multicast.Broadcast(1);
+			REQUIRE(sum == 33);
+			REQUIRE(resource.Allocations >= 10);
+		}
+		REQUIRE(resource.Allocations == resource.Deallocations);
+	}
+
+	SECTION("Multicast Delegate Return Value")
+	{
+		{
+			MulticastDelegateRet<int, int> multicast(&resource);
+			DelegateHandle handles[8];
+			for (int i = 0; i < 8; ++i)
+			{
+				handles[i] = multicast.AddLambda([data, i](int a) { return data[0] + a + i; });
+			}
+			REQUIRE(resource.Allocations >= 9);
+			REQUIRE(multicast.Broadcast<Delegates::Sum<int>>(1) == 60);
+			//Removing keeps the order like the default constructor
+			multicast.Remove(handles[0]);
+			REQUIRE(multicast.Broadcast<Delegates::First<int>>(1) == 5);
+			REQUIRE(multicast.Broadcast<Delegates::Last<int>>(1) == 11);
+		}
+		REQUIRE(resource.Allocations == resource.Deallocations);
+	}
+
+	SECTION("Monotonic Buffer")
+	{
+		std::array<char, 4096> buffer;
+		std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+		MulticastDelegate<int> multicast(&arena);
+		int sum = 0;
+		for (int i = 0; i < 8; ++i)
+		{
+			multicast.AddLambda([data, &sum](int a) { sum += data[0] + a; });
+		}
+		multicast.Broadcast(1);
+		REQUIRE(sum == 32);
+	}
+
+	SECTION("Shared Delegate")
+	{
+		Delegate<int> del;
+		{
+			Delegates::ScopedMemoryResource scope(&resource);
+			del.BindLambda([data]() mutable { return (int)++data[0]; });
+			del.Share();
+		}
+		//The closure and the shared block
+		REQUIRE(resource.Allocations == 2);
+		Delegate<int> copy = del;
+		REQUIRE(resource.Allocations == 2);
+		//Copied on write from the same resource
+		REQUIRE(copy.Execute() == 4);
+		REQUIRE(resource.Allocations == 4);
+		REQUIRE(del.Execute() == 4);
+		copy.Clear();
+		del.Clear();
+		REQUIRE(resource.Deallocations == 4);
+	}
+}
+#endif
+
+namespace ExpiryTest
+{
+	template<typename DelegateT, typename = void>
+	struct HasExecuteIfAlive : std::false_type
+	{};
+
+	template<typename DelegateT>
+	struct HasExecuteIfAlive<DelegateT, decltype(void(std::declval<const DelegateT&>().ExecuteIfAlive()))> : std::true_type
+	{};
+
+	static_assert(HasExecuteIfAlive<Delegate<void>>::value, "ExecuteIfAlive is available without a return value");
+	static_assert(!HasExecuteIfAlive<Delegate<int>>::value, "ExecuteIfAlive is not available with a return value");
+}
+
+TEST_CASE("Expired SP Delegates", "Pruning")
+{
+	struct Listener
+	{
+		void Bar(int a)
+		{
+			Sum += a;
+		}
+		int Sum = 0;
+	};
+
+	SECTION("Delegate")
+	{
+		std::shared_ptr<Foo> foo = std::make_shared<Foo>();
+		Delegate<float, float> del = Delegate<float, float>::CreateSP(foo, &Foo::Bar);
+		REQUIRE(del.Execute(10) == 10);
+		foo.reset();
+		REQUIRE(del.Execute(10) == 0);
+		REQUIRE(del.GetOwner() == nullptr);
+	}
+
+	SECTION("Broadcast")
+	{
+		MulticastDelegate<int> multicast;
+		int staticSum = 0;
+		multicast.AddLambda([&staticSum](int a) { staticSum += a; });
+		std::vector<std::shared_ptr<Listener>> listeners;
+		std::vector<DelegateHandle> handles;
+		for (int i = 0; i < 100; ++i)
+		{
+			listeners.push_back(std::make_shared<Listener>());
+			handles.push_back(multicast.AddSP(listeners.back(), &Listener::Bar));
+		}
+		multicast.Broadcast(1);
+		REQUIRE(multicast.GetSize() == 101);
+
+		//Release every other listener
+		for (size_t i = 0; i < listeners.size(); i += 2)
+		{
+			listeners[i].reset();
+		}
+		multicast.Broadcast(1);
+		REQUIRE(multicast.GetSize() == 51);
+		REQUIRE(staticSum == 2);
+		for (size_t i = 0; i < listeners.size(); ++i)
+		{
+			REQUIRE(multicast.IsBoundTo(handles[i]) == (i % 2 == 1));
+			if (listeners[i])
+			{
+				REQUIRE(listeners[i]->Sum == 2);
+			}
+		}
+		REQUIRE(multicast.Remove(handles[0]) == false);
+		REQUIRE(multicast.Remove(handles[1]));
+		REQUIRE(multicast.GetSize() == 50);
+	}
+
+	SECTION("Nested Broadcast")
+	{
+		MulticastDelegate<int> multicast;
+		std::shared_ptr<Listener> listener = std::make_shared<Listener>();
+		multicast.AddSP(listener, &Listener::Bar);
+		multicast.AddLambda([&](int a)
+			{
+				if (a > 0)
+				{
+					listener.reset();
+					multicast.Broadcast(a - 1);
+					REQUIRE(multicast.GetSize() == 2);
+				}
+			});
+		multicast.Broadcast(1);
+		REQUIRE(multicast.GetSize() == 1);
+	}
+}
+
+TEST_CASE("Multicast Delegate Storage", "Invoke records")
+{
+	using ValueArray = std::array<int, 64>;
+	ValueArray values{};
+	MulticastDelegate<int> multicast;
+	std::vector<DelegateHandle> handles;
+	for (int i = 0; i < 64; ++i)
+	{
+		//Captures are stored inline so they move with the array
+		handles.push_back(multicast.AddLambda([&values, i](int a) { values[i] += a; }));
+	}
+
+	SECTION("Grow")
+	{
+		multicast.Broadcast(1);
+		for (int value : values)
+		{
+			REQUIRE(value == 1);
+		}
+	}
+
+	SECTION("Remove")
+	{
+		for (size_t i = 0; i < handles.size(); i += 3)
+		{
+			REQUIRE(multicast.Remove(handles[i]));
+		}
+		multicast.Broadcast(1);
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			REQUIRE(values[i] == (i % 3 == 0 ? 0 : 1));
+		}
+	}
+
+	SECTION("Copy")
+	{
+		MulticastDelegate<int> copy = multicast;
+		multicast.RemoveAll();
+		copy.Broadcast(2);
+		MulticastDelegate<int> assigned;
+		assigned = copy;
+		copy.RemoveAll();
+		assigned.Broadcast(1);
+		for (int value : values)
+		{
+			REQUIRE(value == 3);
+		}
+	}
+
+	SECTION("Move")
+	{
+		MulticastDelegate<int> moved = std::move(multicast);
+		moved.Broadcast(1);
+		MulticastDelegate<int> assigned;
+		assigned = std::move(moved);
+		assigned.Broadcast(1);
+		for (int value : values)
+		{
+			REQUIRE(value == 2);
+		}
+	}
+
+	SECTION("Add While Broadcasting")
+	{
+		int added = 0;
+		multicast.AddLambda([&multicast, &added](int)
+			{
+				//Reallocates the arrays every now and then
+				multicast.AddLambda([&added](int) { ++added; });
+			});
+		for (int i = 0; i < 10; ++i)
+		{
+			multicast.Broadcast(1);
+		}
+		REQUIRE(multicast.GetSize() == 75);
+		REQUIRE(added == 55);
+		for (int value : values)
+		{
+			REQUIRE(value == 10);
+		}
+	}
+}
+
+TEST_CASE("Multicast Delegate Batch", "BroadcastBatch")
+{
+	using Arguments = MulticastDelegate<int, int>::ArgumentTuple;
+	std::vector<Arguments> batch;
+	for (int i = 0; i < 100; ++i)
+	{
+		batch.emplace_back(i, 1);
+	}
+	MulticastDelegate<int, int> multicast;
+
+	SECTION("Each")
+	{
+		std::vector<int> received;
+		multicast.AddLambda([&received](int a, int b) { received.push_back(a + b); });
+		multicast.AddLambda([&received](int a, int b) { received.push_back(-a - b); });
+		multicast.BroadcastBatch(batch);
+		REQUIRE(received.size() == 200);
+		//Every delegate receives the whole batch in order before the next delegate
+		int sign = received[0] > 0 ? 1 : -1;
+		for (int i = 0; i < 100; ++i)
+		{
+			REQUIRE(received[i] == sign * (i + 1));
+			REQUIRE(received[100 + i] == -sign * (i + 1));
+		}
+	}
+
+	SECTION("Batch Delegate")
+	{
+		int calls = 0;
+		int sum = 0;
+		multicast.AddBatchLambda([&](MulticastDelegate<int, int>::BatchT arguments)
+			{
+				++calls;
+				for (const Arguments& argument : arguments)
+				{
+					sum += std::get<0>(argument) + std::get<1>(argument);
+				}
+			});
+		multicast.BroadcastBatch(batch);
+		REQUIRE(calls == 1);
+		REQUIRE(sum == 5050);
+		multicast.Broadcast(10, 20);
+		REQUIRE(calls == 2);
+		REQUIRE(sum == 5080);
+		multicast.BroadcastBatch(Delegates::Span<const Arguments>());
+		REQUIRE(calls == 3);
+	}
+
+	SECTION("Remove While Broadcasting")
+	{
+		int calls = 0;
+		DelegateHandle handle;
+		handle = multicast.AddLambda([&](int a, int)
+			{
+				++calls;
+				if (a == 9)
+				{
+					multicast.Remove(handle);
+				}
+			});
+		multicast.AddLambda([&](int, int) { ++calls; });
+		multicast.BroadcastBatch(batch);
+		REQUIRE(calls == 110);
+		REQUIRE(multicast.GetSize() == 1);
+	}
+
+	SECTION("Expired")
+	{
+		struct Listener
+		{
+			void Bar(int a, int b)
+			{
+				Sum += a + b;
+			}
+			void Batch(MulticastDelegate<int, int>::BatchT arguments)
+			{
+				Sum += (int)arguments.size();
+			}
+			int Sum = 0;
+		};
+		std::shared_ptr<Listener> listener = std::make_shared<Listener>();
+		std::shared_ptr<Listener> batchListener = std::make_shared<Listener>();
+		multicast.AddSP(listener, &Listener::Bar);
+		multicast.AddBatch(MulticastDelegate<int, int>::BatchDelegateT::CreateSP(batchListener, &Listener::Batch));
+		multicast.BroadcastBatch(batch);
+		REQUIRE(listener->Sum == 5050);
+		REQUIRE(batchListener->Sum == 100);
+		multicast.RemoveObject(batchListener.get());
+		REQUIRE(multicast.GetSize() == 1);
+		multicast.AddBatch(MulticastDelegate<int, int>::BatchDelegateT::CreateSP(batchListener, &Listener::Batch));
+		listener.reset();
+		batchListener.reset();
+		multicast.BroadcastBatch(batch);
+		REQUIRE(multicast.GetSize() == 0);
+	}
+}
+
+TEST_CASE("Parallel Multicast Delegate", "BroadcastParallel")
+{
+	struct SerialExecutor : public Delegates::IExecutor
+	{
+		virtual void ParallelFor(size_t count, TaskFunction pFunction, void* pContext) override
+		{
+			++Calls;
+			for (size_t i = count; i > 0; --i)
+			{
+				pFunction(pContext, i - 1);
+			}
+		}
+		int Calls = 0;
+	};
+
+	std::array<std::atomic<int>, 256> values{};
+	MulticastDelegate<int> multicast;
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		multicast.AddLambda([&values, i](int a) { values[i] += a; });
+	}
+
+	SECTION("Custom Executor")
+	{
+		SerialExecutor executor;
+		multicast.BroadcastParallel(executor, 2);
+		REQUIRE(executor.Calls == 1);
+		for (const std::atomic<int>& value : values)
+		{
+			REQUIRE(value == 2);
+		}
+	}
+
+	SECTION("Work Stealing Executor")
+	{
+		Delegates::WorkStealingExecutor executor(3);
+		REQUIRE(executor.GetThreadCount() == 3);
+		std::atomic<int> total(0);
+		multicast.AddLambda([&](int a)
+			{
+				//Nested parallel work from within a task
+				std::array<int, 64> nested{};
+				executor.ParallelFor(nested.size(), [](void* pContext, size_t index)
+					{
+						(*static_cast<std::array<int, 64>*>(pContext))[index] = 1;
+					}, &nested);
+				for (int value : nested)
+				{
+					total += value * a;
+				}
+			});
+		for (int i = 0; i < 100; ++i)
+		{
+			multicast.BroadcastParallel(executor, 1);
+		}
+		REQUIRE(total == 6400);
+		for (const std::atomic<int>& value : values)
+		{
+			REQUIRE(value == 100);
+		}
+	}
+
+	SECTION("Default Executor")
+	{
+		multicast.BroadcastParallel(3);
+		for (const std::atomic<int>& value : values)
+		{
+			REQUIRE(value == 3);
+		}
+	}
+
+	SECTION("Expired")
+	{
+		struct Listener
+		{
+			void Bar(int a)
+			{
+				Sum += a;
+			}
+			int Sum = 0;
+		};
+		std::vector<std::shared_ptr<Listener>> listeners;
+		for (int i = 0; i < 64; ++i)
+		{
+			listeners.push_back(std::make_shared<Listener>());
+			multicast.AddSP(listeners.back(), &Listener::Bar);
+		}
+		for (size_t i = 0; i < listeners.size(); i += 2)
+		{
+			listeners[i].reset();
+		}
+		Delegates::WorkStealingExecutor executor(2);
+		multicast.BroadcastParallel(executor, 1);
+		REQUIRE(multicast.GetSize() == values.size() + 32);
+		for (size_t i = 1; i < listeners.size(); i += 2)
+		{
+			REQUIRE(listeners[i]->Sum == 1);
+		}
+	}
+}
+
+TEST_CASE("Async Delegate", "ExecuteOn")
+{
+	//Keeps the posted tasks until Flush
+	struct DeferredExecutor : public Delegates::IExecutor
+	{
+		virtual void ParallelFor(size_t count, TaskFunction pFunction, void* pContext) override
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				pFunction(pContext, i);
+			}
+		}
+		virtual void Post(TaskFunction pFunction, void* pContext) override
+		{
+			Tasks.emplace_back(pFunction, pContext);
+		}
+		void Flush()
+		{
+			for (const std::pair<TaskFunction, void*>& task : Tasks)
+			{
+				task.first(task.second, 0);
+			}
+			Tasks.clear();
+		}
+		std::vector<std::pair<TaskFunction, void*>> Tasks;
+	};
+
+	SECTION("Result")
+	{
+		Delegates::WorkStealingExecutor executor(2);
+		Delegate<int, int, int> del = Delegate<int, int, int>::CreateLambda([](int a, int b) { return a * b; });
+		std::vector<DelegateFuture<int>> futures;
+		for (int i = 0; i < 100; ++i)
+		{
+			futures.push_back(del.ExecuteOn(executor, i, 2));
+		}
+		for (int i = 0; i < 100; ++i)
+		{
+			REQUIRE(futures[i].Get() == i * 2);
+			REQUIRE(futures[i].IsReady());
+		}
+	}
+
+	SECTION("Void")
+	{
+		std::atomic<int> calls(0);
+		Delegate<void> del = Delegate<void>::CreateLambda([&calls]() { ++calls; });
+		DelegateFuture<void> future = del.ExecuteAsync();
+		future.Wait();
+		future.Get();
+		REQUIRE(future.IsReady());
+		REQUIRE(calls == 1);
+	}
+
+	SECTION("Copied Arguments")
+	{
+		DeferredExecutor executor;
+		Delegate<size_t, const std::string&> del = Delegate<size_t, const std::string&>::CreateLambda([](const std::string& text) { return text.size(); });
+		std::string text = "Hello";
+		DelegateFuture<size_t> future = del.ExecuteOn(executor, text);
+		text = "Hello World";
+		del.Clear();
+		REQUIRE(future.IsReady() == false);
+		executor.Flush();
+		REQUIRE(future.Get() == 5);
+	}
+
+	SECTION("Continuation")
+	{
+		DeferredExecutor executor;
+		Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a) { return a + 1; });
+		int result = 0;
+		DelegateFuture<int> future = del.ExecuteOn(executor, 1);
+		future.ThenLambda([&result](const int& value) { result = value; });
+		REQUIRE(result == 0);
+		executor.Flush();
+		REQUIRE(result == 2);
+
+		//Runs right away when the result is already there
+		DelegateFuture<int> other = del.ExecuteOn(executor, 10);
+		executor.Flush();
+		other.ThenLambda([&result](const int& value) { result = value; });
+		REQUIRE(result == 11);
+	}
+
+	SECTION("Cancel")
+	{
+		DeferredExecutor executor;
+		int calls = 0;
+		int continuations = 0;
+		Delegate<void> del = Delegate<void>::CreateLambda([&calls]() { ++calls; });
+		DelegateFuture<void> future = del.ExecuteOn(executor);
+		future.ThenLambda([&continuations]() { ++continuations; });
+		REQUIRE(future.Cancel());
+		REQUIRE(future.IsCancelled());
+		future.Wait();
+		executor.Flush();
+		REQUIRE(calls == 0);
+		REQUIRE(continuations == 0);
+		REQUIRE(future.Cancel() == false);
+#if DELEGATE_EXCEPTIONS
+		REQUIRE_THROWS_AS(future.Get(), Delegates::CancelledError);
+
+		Delegate<int> value = Delegate<int>::CreateLambda([]() { return 1; });
+		DelegateFuture<int> cancelled = value.ExecuteOn(executor);
+		REQUIRE(cancelled.Cancel());
+		REQUIRE_THROWS_AS(cancelled.Get(), Delegates::CancelledError);
+		executor.Flush();
+#endif
+
+		DelegateFuture<void> finished = del.ExecuteOn(executor);
+		executor.Flush();
+		REQUIRE(finished.Cancel() == false);
+		REQUIRE(calls == 1);
+	}
+
+#if DELEGATE_EXCEPTIONS
+	SECTION("Exception")
+	{
+		Delegates::WorkStealingExecutor executor(2);
+		int continuations = 0;
+		Delegate<int, int> del = Delegate<int, int>::CreateLambda([](int a) -> int { throw std::runtime_error(std::to_string(a)); });
+		DelegateFuture<int> future = del.ExecuteOn(executor, 4);
+		future.Wait();
+		REQUIRE(future.IsFailed());
+		REQUIRE(future.IsReady() == false);
+		REQUIRE_THROWS_AS(future.Get(), std::runtime_error);
+		future.ThenLambda([&continuations](const int&) { ++continuations; });
+		REQUIRE(continuations == 0);
+
+		DelegateFuture<void> deferred = Delegate<void>::CreateLambda([]() { throw 1; }).ExecuteAsync();
+		REQUIRE_THROWS_AS(deferred.Get(), int);
+	}
+#endif
+
+	SECTION("Released Future")
+	{
+		DeferredExecutor executor;
+		std::shared_ptr<int> pValue = std::make_shared<int>(3);
+		Delegate<int> del = Delegate<int>::CreateLambda([pValue]() { return *pValue; });
+		del.ExecuteOn(executor).Reset();
+		REQUIRE(pValue.use_count() == 3);
+		executor.Flush();
+		REQUIRE(pValue.use_count() == 2);
+	}
+}
+
+TEST_CASE("Event Queue", "EventQueue")
+{
+	EventQueue queue(256);
+	MulticastDelegate<int> first;
+	MulticastDelegate<int> second;
+	std::vector<int> received;
+	first.AddLambda([&received](int a) { received.push_back(a); });
+	second.AddLambda([&received](int a) { received.push_back(-a); });
+
+	SECTION("Order")
+	{
+		for (int i = 1; i <= 100; ++i)
+		{
+			queue.Enqueue(i % 2 ? first : second, i);
+		}
+		REQUIRE(queue.GetSize() == 100);
+		REQUIRE(received.empty());
+		queue.Flush();
+		REQUIRE(queue.IsEmpty());
+		REQUIRE(received.size() == 100);
+		for (int i = 1; i <= 100; ++i)
+		{
+			REQUIRE(received[i - 1] == (i % 2 ? i : -i));
+		}
+	}
+
+	SECTION("Grouped")
+	{
+		for (int i = 1; i <= 100; ++i)
+		{
+			queue.Enqueue(i % 2 ? first : second, i);
+		}
+		queue.FlushGrouped();
+		REQUIRE(received.size() == 100);
+		//Each delegate receives its events together and in order
+		int sign = received[0] > 0 ? 1 : -1;
+		for (int i = 0; i < 50; ++i)
+		{
+			REQUIRE(received[i] == sign * (sign > 0 ? i * 2 + 1 : i * 2 + 2));
+			REQUIRE(received[50 + i] == -sign * (sign > 0 ? i * 2 + 2 : i * 2 + 1));
+		}
+	}
+
+	SECTION("Enqueue While Flushing")
+	{
+		MulticastDelegate<int> cascade;
+		cascade.AddLambda([&](int a)
+			{
+				received.push_back(a);
+				queue.Enqueue(cascade, a + 1);
+			});
+		queue.Enqueue(cascade, 0);
+		queue.Flush();
+		REQUIRE(received.size() == 1);
+		REQUIRE(queue.GetSize() == 1);
+		queue.Flush();
+		REQUIRE(received.size() == 2);
+		REQUIRE(received[1] == 1);
+		queue.Clear();
+		queue.Flush();
+		REQUIRE(received.size() == 2);
+	}
+
+	SECTION("Arguments")
+	{
+		MulticastDelegate<const std::string&> strings;
+		std::string result;
+		strings.AddLambda([&result](const std::string& text) { result += text; });
+		std::string text = "Hello";
+		queue.Enqueue(strings, text);
+		text = " World";
+		queue.Enqueue(strings, text);
+		//Larger than a page
+		queue.Enqueue(strings, std::string(1024, 'a'));
+		REQUIRE(text == " World");
+		queue.Flush();
+		REQUIRE(result == "Hello World" + std::string(1024, 'a'));
+
+		//Destroyed without broadcasting
+		std::shared_ptr<int> pValue = std::make_shared<int>(1);
+		MulticastDelegate<std::shared_ptr<int>> pointers;
+		queue.Enqueue(pointers, pValue);
+		REQUIRE(pValue.use_count() == 2);
+		queue.Clear();
+		REQUIRE(pValue.use_count() == 1);
+	}
+
+#if DELEGATE_EXCEPTIONS
+	SECTION("Throwing Arguments")
+	{
+		struct Throwing
+		{
+			Throwing() = default;
+			Throwing(const Throwing&) { throw std::runtime_error("copy"); }
+		};
+		MulticastDelegate<const Throwing&> throwing;
+		int calls = 0;
+		throwing.AddLambda([&calls](const Throwing&) { ++calls; });
+		queue.Enqueue(first, 1);
+		Throwing value;
+		REQUIRE_THROWS_AS(queue.Enqueue(throwing, value), std::runtime_error);
+		REQUIRE(queue.GetSize() == 1);
+		queue.Enqueue(first, 2);
+		queue.Flush();
+		REQUIRE(calls == 0);
+		REQUIRE(received == std::vector<int>{ 1, 2 });
+	}
+#endif
+
+	SECTION("Discard")
+	{
+		queue.Enqueue(first, 1);
+		queue.Enqueue(second, 2);
+		queue.Enqueue(first, 3);
+		queue.Discard(first);
+		queue.Flush();
+		REQUIRE(received.size() == 1);
+		REQUIRE(received[0] == -2);
+
+		//Discarding a delegate while flushing skips its pending events
+		received.clear();
+		MulticastDelegate<int> discarding;
+		discarding.AddLambda([&](int) { queue.Discard(first); });
+		queue.Enqueue(discarding, 0);
+		queue.Enqueue(first, 1);
+		queue.Flush();
+		REQUIRE(received.empty());
+	}
+
+	SECTION("Nested Flush")
+	{
+		//A listener flushes again and a listener of that flush destroys a delegate with an event in the outer flush
+		std::unique_ptr<MulticastDelegate<int>> pTarget = std::make_unique<MulticastDelegate<int>>();
+		pTarget->AddLambda([&](int a) { received.push_back(a * 100); });
+		MulticastDelegate<int> destroying;
+		destroying.AddLambda([&](int)
+			{
+				queue.Discard(*pTarget);
+				pTarget.reset();
+			});
+		MulticastDelegate<int> flushing;
+		flushing.AddLambda([&](int)
+			{
+				queue.Enqueue(first, 2);
+				queue.Enqueue(destroying, 0);
+				queue.Flush();
+			});
+		queue.Enqueue(flushing, 0);
+		queue.Enqueue(*pTarget, 1);
+		queue.Enqueue(first, 3);
+		queue.Flush();
+		REQUIRE(received.size() == 2);
+		REQUIRE(received[0] == 2);
+		REQUIRE(received[1] == 3);
+		REQUIRE(queue.IsEmpty());
+	}
+}
+
+TEST_CASE("Delegate Dispatcher", "DelegateDispatcher")
+{
+	DelegateDispatcher dispatcher;
+	REQUIRE(dispatcher.IsOwnerThread());
+
+	SECTION("Order")
+	{
+		std::vector<int> received;
+		Delegate<void, int> del = Delegate<void, int>::CreateLambda([&received](int a) { received.push_back(a); });
+		for (int i = 0; i < 100; ++i)
+		{
+			dispatcher.Post(del, i);
+		}
+		dispatcher.PostLambda([&received](int payload) { received.push_back(payload); }, 100);
+		REQUIRE(received.empty());
+		REQUIRE(dispatcher.Dispatch() == 101);
+		REQUIRE(received.size() == 101);
+		for (int i = 0; i <= 100; ++i)
+		{
+			REQUIRE(received[i] == i);
+		}
+		REQUIRE(dispatcher.Dispatch() == 0);
+	}
+
+	SECTION("Post While Dispatching")
+	{
+		int calls = 0;
+		Delegate<void> post;
+		post.BindLambda([&]()
+			{
+				++calls;
+				dispatcher.Post(post);
+			});
+		dispatcher.Post(post);
+		REQUIRE(dispatcher.Dispatch() == 1);
+		REQUIRE(dispatcher.Dispatch() == 1);
+		REQUIRE(calls == 2);
+	}
+
+	SECTION("Arguments")
+	{
+		std::string result;
+		Delegate<void, const std::string&> del = Delegate<void, const std::string&>::CreateLambda([&result](const std::string& text) { result += text; });
+		std::string text = "Hello";
+		dispatcher.Post(del, text);
+		text = " World";
+		dispatcher.Post(del, text);
+		dispatcher.Dispatch();
+		REQUIRE(result == "Hello World");
+
+		//Dropped without running
+		std::shared_ptr<int> pValue = std::make_shared<int>(1);
+		{
+			DelegateDispatcher other;
+			other.PostLambda([](const std::shared_ptr<int>&) {}, pValue);
+			REQUIRE(pValue.use_count() == 2);
+		}
+		REQUIRE(pValue.use_count() == 1);
+	}
+
+	SECTION("Threaded")
+	{
+		constexpr int threadCount = 4;
+		constexpr int postCount = 2000;
+		std::vector<int> sums(threadCount);
+		std::vector<int> last(threadCount, -1);
+		bool ordered = true;
+		Delegate<void, int, int> del = Delegate<void, int, int>::CreateLambda([&](int thread, int value)
+			{
+				ordered &= value == last[thread] + 1;
+				last[thread] = value;
+				sums[thread] += value;
+			});
+		std::atomic<int> finished(0);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([&, t]()
+				{
+					for (int i = 0; i < postCount; ++i)
+					{
+						dispatcher.Post(del, t, i);
+					}
+					++finished;
+				});
+		}
+		int dispatched = 0;
+		while (finished < threadCount)
+		{
+			dispatched += (int)dispatcher.Dispatch();
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		dispatched += (int)dispatcher.Dispatch();
+		REQUIRE(dispatched == threadCount * postCount);
+		REQUIRE(ordered);
+		for (int t = 0; t < threadCount; ++t)
+		{
+			REQUIRE(sums[t] == postCount * (postCount - 1) / 2);
+		}
+	}
+}
+
+TEST_CASE("Multicast Delegate Priority", "Priority")
+{
+	MulticastDelegate<std::vector<int>&> multicast;
+	std::vector<int> order;
+	auto add = [&multicast](int id, int priority)
+	{
+		return multicast.Add(MulticastDelegate<std::vector<int>&>::DelegateT::CreateLambda([id](std::vector<int>& result) { result.push_back(id); }), priority);
+	};
+
+	SECTION("Order")
+	{
+		add(1, 0);
+		add(2, 10);
+		add(3, -5);
+		add(4, 10);
+		multicast.AddLambda([](std::vector<int>& result) { result.push_back(5); });
+		add(6, 5);
+		multicast.Broadcast(order);
+		REQUIRE(order == std::vector<int>({ 2, 4, 6, 1, 5, 3 }));
+	}
+
+	SECTION("Remove")
+	{
+		std::vector<DelegateHandle> handles;
+		for (int i = 0; i < 10; ++i)
+		{
+			handles.push_back(add(i, i / 3));
+		}
+		multicast.Remove(handles[4]);
+		multicast.Remove(handles[9]);
+		multicast.Remove(handles[0]);
+		REQUIRE(multicast.GetSize() == 7);
+		multicast.Broadcast(order);
+		REQUIRE(order == std::vector<int>({ 6, 7, 8, 3, 5, 1, 2 }));
+		for (int i : { 1, 2, 3, 5, 6, 7, 8 })
+		{
+			REQUIRE(multicast.IsBoundTo(handles[i]));
+			REQUIRE(multicast.GetPriority(handles[i]) == i / 3);
+		}
+		//Slots are reused
+		DelegateHandle handle = add(10, 1);
+		order.clear();
+		multicast.Broadcast(order);
+		REQUIRE(order == std::vector<int>({ 6, 7, 8, 3, 5, 10, 1, 2 }));
+		REQUIRE(multicast.Remove(handle));
+		REQUIRE(multicast.IsBoundTo(handles[5]));
+	}
+
+	SECTION("Remove Object")
+	{
+		struct Listener
+		{
+			void Call(std::vector<int>& result) { result.push_back(Id); }
+			int Id;
+		};
+		//Removing the first delegates leaves tombstones in front, removing more compresses the arrays
+		std::vector<DelegateHandle> handles;
+		for (int i = 0; i < 4; ++i)
+		{
+			handles.push_back(add(i, 10));
+		}
+		Listener listener{ 7 };
+		Listener other{ 8 };
+		for (int i = 0; i < 6; ++i)
+		{
+			multicast.AddRaw(&listener, &Listener::Call);
+		}
+		multicast.AddRaw(&other, &Listener::Call);
+		for (DelegateHandle& handle : handles)
+		{
+			multicast.Remove(handle);
+		}
+		multicast.RemoveObject(&listener);
+		REQUIRE(multicast.GetSize() == 1);
+		multicast.Broadcast(order);
+		REQUIRE(order == std::vector<int>({ 8 }));
+	}
+
+	SECTION("Set Priority")
+	{
+		DelegateHandle first = add(1, 0);
+		add(2, 0);
+		DelegateHandle third = add(3, 0);
+		REQUIRE(multicast.SetPriority(third, 1));
+		REQUIRE(multicast.SetPriority(first, -1));
+		multicast.Broadcast(order);
+		REQUIRE(order == std::vector<int>({ 3, 2, 1 }));
+		REQUIRE(multicast.GetPriority(third) == 1);
+		multicast.Remove(third);
+		REQUIRE(multicast.SetPriority(third, 5) == false);
+	}
+
+	SECTION("While Broadcasting")
+	{
+		DelegateHandle self;
+		bool changed = false;
+		add(1, 5);
+		self = multicast.AddLambda([&](std::vector<int>& result)
+			{
+				result.push_back(2);
+				if (changed == false)
+				{
+					changed = true;
+					multicast.SetPriority(self, 10);
+					add(3, 7);
+				}
+			});
+		add(4, -1);
+		multicast.Broadcast(order);
+		//Added delegates run at the end of the broadcast that added them
+		REQUIRE(order == std::vector<int>({ 1, 2, 4, 3 }));
+		order.clear();
+		multicast.Broadcast(order);
+		REQUIRE(order == std::vector<int>({ 2, 3, 1, 4 }));
+	}
+
+	SECTION("Churn")
+	{
+		//Reference: sorted by priority, then by the order they were added or changed priority
+		struct Entry
+		{
+			int Id;
+			int Priority;
+			int Sequence;
+			DelegateHandle Handle;
+		};
+		std::vector<Entry> entries;
+		int sequence = 0;
+		srand(10);
+		for (int i = 0; i < 2000; ++i)
+		{
+			int action = rand() % 10;
+			if (action < 5 || entries.empty())
+			{
+				int priority = rand() % 8;
+				entries.push_back(Entry{ i, priority, sequence++, add(i, priority) });
+			}
+			else if (action < 8)
+			{
+				size_t index = rand() % entries.size();
+				REQUIRE(multicast.Remove(entries[index].Handle));
+				entries.erase(entries.begin() + index);
+			}
+			else
+			{
+				Entry& entry = entries[rand() % entries.size()];
+				int priority = rand() % 8;
+				REQUIRE(multicast.SetPriority(entry.Handle, priority));
+				if (priority != entry.Priority)
+				{
+					entry.Priority = priority;
+					entry.Sequence = sequence++;
+				}
+			}
+			if (i % 100 == 0)
+			{
+				std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+					{
+						return a.Priority != b.Priority ? a.Priority > b.Priority : a.Sequence < b.Sequence;
+					});
+				std::vector<int> expected;
+				for (const Entry& entry : entries)
+				{
+					expected.push_back(entry.Id);
+				}
+				order.clear();
+				multicast.Broadcast(order);
+				REQUIRE(order == expected);
+				REQUIRE(multicast.GetSize() == entries.size());
+			}
+		}
+	}
+}
+
+TEST_CASE("Multicast Delegate Return Value", "MulticastDelegateRet")
+{
+	MulticastDelegateRet<int, int> multicast;
+	for (int i = 1; i <= 4; ++i)
+	{
+		multicast.AddLambda([i](int a) { return a * i; });
+	}
+
+	SECTION("Combiners")
+	{
+		REQUIRE(multicast.Broadcast<Delegates::First<int>>(2) == 2);
+		REQUIRE(multicast.Broadcast<Delegates::Last<int>>(2) == 8);
+		REQUIRE(multicast.Broadcast<Delegates::Sum<int>>(2) == 20);
+		REQUIRE(multicast.Broadcast<Delegates::Min<int>>(-1) == -4);
+		REQUIRE(multicast.Broadcast<Delegates::Max<int>>(-1) == -1);
+		REQUIRE(multicast.Broadcast<Delegates::AllOf>(1));
+		REQUIRE_FALSE(multicast.Broadcast<Delegates::AllOf>(0));
+
+		MulticastDelegateRet<int, int> empty;
+		Delegates::Min<int> min;
+		REQUIRE(empty.Broadcast(min, 1) == 0);
+		REQUIRE_FALSE(min.HasValue());
+		REQUIRE(empty.Broadcast<Delegates::AllOf>(1));
+	}
+
+	SECTION("Write To Span")
+	{
+		int results[3] = {};
+		Delegates::WriteToSpan<int> writer(results);
+		REQUIRE(multicast.Broadcast(writer, 10) == 3);
+		REQUIRE(results[0] == 10);
+		REQUIRE(results[1] == 20);
+		REQUIRE(results[2] == 30);
+
+		std::vector<int> all(8);
+		Delegates::WriteToSpan<int> allWriter(all);
+		REQUIRE(multicast.Broadcast(allWriter, 1) == 4);
+		REQUIRE(all[3] == 4);
+	}
+
+	SECTION("Stop Early")
+	{
+		int calls = 0;
+		MulticastDelegateRet<bool> checks;
+		checks.AddLambda([&calls]() { ++calls; return true; });
+		checks.AddLambda([&calls]() { ++calls; return false; });
+		checks.AddLambda([&calls]() { ++calls; return true; });
+		REQUIRE_FALSE(checks.Broadcast<Delegates::AllOf>());
+		REQUIRE(calls == 2);
+		checks.Broadcast();
+		REQUIRE(calls == 5);
+	}
+
+	SECTION("Remove")
+	{
+		DelegateHandle handle;
+		handle = multicast.AddLambda([&](int a)
+			{
+				multicast.Remove(handle);
+				return a * 100;
+			});
+		REQUIRE(multicast.Broadcast<Delegates::Sum<int>>(1) == 110);
+		REQUIRE(multicast.GetSize() == 4);
+		REQUIRE(multicast.Broadcast<Delegates::Sum<int>>(1) == 10);
+		//Order is kept
+		multicast.RemoveAll();
+		multicast.AddLambda([](int a) { return a + 1; });
+		multicast.AddLambda([](int a) { return a + 2; });
+		REQUIRE(multicast.Broadcast<Delegates::First<int>>(0) == 1);
+	}
+
+	SECTION("Expired")
+	{
+		struct Score
+		{
+			float Evaluate(float a) const { return a * Weight; }
+			float Weight = 2.0f;
+		};
+		DECLARE_MULTICAST_DELEGATE_RET(ScoreEvent, float, float);
+		ScoreEvent scores;
+		std::shared_ptr<Score> pScore = std::make_shared<Score>();
+		scores.AddSP(pScore, &Score::Evaluate);
+		scores += ScoreEventDelegate::CreateLambda([](float a) { return a; });
+		REQUIRE(scores.Broadcast<Delegates::Min<float>>(3.0f) == 3.0f);
+		REQUIRE(scores.Broadcast<Delegates::Max<float>>(3.0f) == 6.0f);
+		pScore.reset();
+		REQUIRE(scores.Broadcast<Delegates::Sum<float>>(3.0f) == 3.0f);
+		REQUIRE(scores.GetSize() == 1);
+
+		//Bound outside of AddSP, the expired delegate must not give a default value to the combiner
+		struct Offset
+		{
+			int Add(int a) const { return a + Value; }
+			int Value = 0;
+		};
+		std::shared_ptr<Offset> pOffset = std::make_shared<Offset>();
+		multicast.Add(MulticastDelegateRet<int, int>::DelegateT::CreateSP(pOffset, &Offset::Add));
+		MulticastDelegateRet<int, int>::DelegateT shared = MulticastDelegateRet<int, int>::DelegateT::CreateSP(pOffset, &Offset::Add);
+		shared.Share();
+		multicast.Add(std::move(shared));
+		REQUIRE(multicast.Broadcast<Delegates::Min<int>>(-1) == -4);
+		pOffset.reset();
+		REQUIRE(multicast.Broadcast<Delegates::Min<int>>(51) == 51);
+		REQUIRE(multicast.GetSize() == 4);
+	}
+
+	SECTION("Priority")
+	{
+		multicast.Add(MulticastDelegateRet<int, int>::DelegateT::CreateLambda([](int a) { return a * 10; }), 1);
+		REQUIRE(multicast.Broadcast<Delegates::First<int>>(1) == 10);
+		REQUIRE(multicast.Broadcast<Delegates::Last<int>>(1) == 4);
+	}
+}
+
+namespace StaticMulticastTest
+{
+	std::vector<int> Calls;
+	void First(int a) { Calls.push_back(a); }
+	void Second(int a) { Calls.push_back(a * 10); }
+	void Append(std::string& text, const std::string& suffix) { text += suffix; }
+}
+
+TEST_CASE("Static Multicast Delegate", "StaticMulticastDelegate")
+{
+	using namespace StaticMulticastTest;
+	Calls.clear();
+
+	SECTION("Broadcast")
+	{
+		using Multicast = StaticMulticastDelegate<void(*)(int), &First, &Second, &First>;
+		static_assert(Multicast::GetSize() == 3, "Wrong amount of functions");
+		Multicast::Broadcast(2);
+		REQUIRE(Calls == std::vector<int>({ 2, 20, 2 }));
+		Multicast()(3);
+		REQUIRE(Calls.size() == 6);
+
+		StaticMulticastDelegate<void(*)(std::string&, const std::string&), &Append, &Append> appender;
+		std::string text;
+		appender(text, "a");
+		REQUIRE(text == "aa");
+	}
+
+	SECTION("Add To Multicast")
+	{
+		MulticastDelegate<int> multicast;
+		multicast.AddStatic(&StaticMulticastDelegate<void(*)(int), &Second, &First>::Broadcast);
+		multicast.Broadcast(1);
+		REQUIRE(Calls == std::vector<int>({ 10, 1 }));
+	}
+
+#if DELEGATE_AUTO_TEMPLATE
+	SECTION("Auto")
+	{
+		StaticMulticast<&First, &Second>::Broadcast(4);
+		REQUIRE(Calls == std::vector<int>({ 4, 40 }));
+	}
+#endif
+}
+
+namespace DirectDelegateTest
+{
+	int Add(int a, int b) { return a + b; }
+	void Store(int a, int* pOut) { *pOut = a; }
+
+	struct Counter
+	{
+		int Increment(int amount) { Value += amount; return Value; }
+		int Get() const { return Value; }
+		int Value = 0;
+	};
+}
+
+TEST_CASE("Direct Delegate", "Create")
+{
+	using namespace DirectDelegateTest;
+
+	SECTION("Static")
+	{
+		Delegate<int, int> del = Delegate<int, int>::Create<decltype(&Add), &Add>(10);
+		REQUIRE(del.Execute(5) == 15);
+		Delegate<int, int, int> plain = Delegate<int, int, int>::Create<decltype(&Add), &Add>();
+		REQUIRE(plain.Execute(1, 2) == 3);
+
+		//The payload is a pointer, it is not mistaken for an object
+		int out = 0;
+		Delegate<void, int> store = Delegate<void, int>::Create<decltype(&Store), &Store>(&out);
+		store.Execute(7);
+		REQUIRE(out == 7);
+	}
+
+	SECTION("Member")
+	{
+		Counter counter;
+		Delegate<int, int> del = Delegate<int, int>::Create<decltype(&Counter::Increment), &Counter::Increment>(&counter);
+		//No member function pointer is stored
+		REQUIRE(del.GetSize() < Delegate<int, int>::CreateRaw(&counter, &Counter::Increment).GetSize());
+		REQUIRE(del.Execute(2) == 2);
+		REQUIRE(del.Execute(3) == 5);
+		REQUIRE(del.GetOwner() == &counter);
+
+		const Counter& constCounter = counter;
+		Delegate<int> get = Delegate<int>::Create<decltype(&Counter::Get), &Counter::Get>(&constCounter);
+		REQUIRE(get.Execute() == 5);
+
+		//Copies and multicast
+		Delegate<int, int> copy = del;
+		REQUIRE(copy.Execute(1) == 6);
+		MulticastDelegate<int> multicast;
+		multicast.Add(MulticastDelegate<int>::DelegateT::Create<decltype(&Counter::Increment), &Counter::Increment>(&counter));
+		multicast.Broadcast(4);
+		REQUIRE(counter.Value == 10);
+		multicast.RemoveObject(&counter);
+		REQUIRE(multicast.GetSize() == 0);
+	}
+
+#if DELEGATE_AUTO_TEMPLATE
+	SECTION("Auto")
+	{
+		Counter counter;
+		Delegate<int, int> member = Delegate<int, int>::Create<&Counter::Increment>(&counter);
+		REQUIRE(member.Execute(3) == 3);
+		Delegate<int, int> global = Delegate<int, int>::Create<&Add>(1);
+		REQUIRE(global.Execute(3) == 4);
+	}
+#endif
+}
+
+TEST_CASE("Compact Delegate", "CompactDelegate")
+{
+	using namespace DirectDelegateTest;
+
+	REQUIRE(sizeof(CompactDelegate<void, int>) == 3 * sizeof(void*));
+
+	SECTION("Bind")
+	{
+		CompactDelegate<int, int> del;
+		REQUIRE(del.IsBound() == false);
+		REQUIRE(del.ExecuteIfBound(1) == 0);
+
+		del = CompactDelegate<int, int>::CreateStatic(&Add, 10);
+		REQUIRE(del.Execute(5) == 15);
+
+		Counter counter;
+		del.BindRaw(&counter, &Counter::Increment);
+		REQUIRE(del.Execute(2) == 2);
+		REQUIRE(del.IsBoundTo(&counter));
+		del.ClearIfBoundTo(&counter);
+		REQUIRE(del.IsBound() == false);
+
+		del = CompactDelegate<int, int>::Create<decltype(&Counter::Increment), &Counter::Increment>(&counter);
+		REQUIRE(del.Execute(3) == 5);
+		REQUIRE(del.GetOwner() == &counter);
+
+		int captured = 7;
+		del.BindLambda([&captured](int a) { return a + captured; });
+		REQUIRE(del.Execute(1) == 8);
+		REQUIRE(del.GetOwner() == nullptr);
+	}
+
+	SECTION("Shared Pointer")
+	{
+		std::shared_ptr<Counter> pCounter = std::make_shared<Counter>();
+		CompactDelegate<int, int> del = CompactDelegate<int, int>::CreateSP(pCounter, &Counter::Increment);
+		REQUIRE(del.Execute(4) == 4);
+		REQUIRE(del.GetOwner() == pCounter.get());
+		pCounter.reset();
+		REQUIRE(del.GetOwner() == nullptr);
+		REQUIRE(del.Execute(4) == 0);
+	}
+
+	SECTION("Heap")
+	{
+		//Doesn't fit in a pointer and has a destructor
+		std::shared_ptr<int> pValue = std::make_shared<int>(3);
+		std::array<int, 8> big{};
+		big[7] = 10;
+		CompactDelegate<int, int> del = CompactDelegate<int, int>::CreateLambda([pValue, big](int a) { return a + *pValue + big[7]; });
+		REQUIRE(pValue.use_count() == 2);
+		REQUIRE(del.Execute(1) == 14);
+
+		CompactDelegate<int, int> copy = del;
+		REQUIRE(pValue.use_count() == 3);
+		REQUIRE(copy.Execute(1) == 14);
+
+		CompactDelegate<int, int> moved = std::move(del);
+		REQUIRE(del.IsBound() == false);
+		REQUIRE(pValue.use_count() == 3);
+		REQUIRE(moved.Execute(2) == 15);
+
+		copy = moved;
+		moved.Clear();
+		copy.Clear();
+		REQUIRE(pValue.use_count() == 1);
+	}
+
+	SECTION("Lambda Lvalue")
+	{
+		//Lvalue lambdas are copied, not moved from
+		std::shared_ptr<int> pValue = std::make_shared<int>(1);
+		auto lambda = [pValue](int a) { return a + *pValue; };
+		CompactDelegate<int, int> del = CompactDelegate<int, int>::CreateLambda(lambda);
+		REQUIRE(pValue.use_count() == 3);
+		REQUIRE(lambda(1) == 2);
+		REQUIRE(del.Execute(1) == 2);
+	}
+}
+
+TEST_CASE("Compact Multicast Delegate", "CompactMulticastDelegate")
+{
+	REQUIRE(sizeof(CompactMulticastDelegate<int>) == sizeof(void*));
+
+	SECTION("Lazy Allocation")
+	{
+		CompactMulticastDelegate<int> del;
+		REQUIRE(del.GetListeners() == nullptr);
+		del.Broadcast(1);
+		REQUIRE(del.GetSize() == 0);
+
+		int total = 0;
+		DelegateHandle a = del.AddLambda([&total](int v) { total += v; });
+		DelegateHandle b = del.AddLambda([&total](int v) { total += v * 10; });
+		REQUIRE(del.GetListeners() != nullptr);
+		REQUIRE(del.GetSize() == 2);
+		del.Broadcast(1);
+		REQUIRE(total == 11);
+
+		REQUIRE(del.Remove(a));
+		REQUIRE(del.GetListeners() != nullptr);
+		REQUIRE(del.Remove(b));
+		REQUIRE(del.GetListeners() == nullptr);
+		REQUIRE(del.Remove(b) == false);
+	}
+
+	SECTION("Remove While Broadcasting")
+	{
+		CompactMulticastDelegate<int> del;
+		DelegateHandle handle;
+		int calls = 0;
+		handle = del.AddLambda([&](int) { ++calls; del.Remove(handle); });
+		del.Broadcast(1);
+		del.Broadcast(1);
+		REQUIRE(calls == 1);
+		REQUIRE(del.GetListeners() == nullptr);
+	}
+
+	SECTION("Copy And Move")
+	{
+		std::shared_ptr<int> pValue = std::make_shared<int>(0);
+		CompactMulticastDelegate<int> del;
+		del.AddLambda([pValue](int v) { *pValue += v; });
+		del.Add(MulticastDelegate<int>::DelegateT::CreateLambda([pValue](int v) { *pValue += v; }), 5);
+
+		CompactMulticastDelegate<int> copy = del;
+		REQUIRE(copy.GetListeners() != del.GetListeners());
+		copy.Broadcast(1);
+		REQUIRE(*pValue == 2);
+
+		CompactMulticastDelegate<int> moved = std::move(del);
+		REQUIRE(del.GetListeners() == nullptr);
+		moved.Broadcast(2);
+		REQUIRE(*pValue == 6);
+
+		copy = del;
+		REQUIRE(copy.GetListeners() == nullptr);
+		moved.RemoveAll();
+		REQUIRE(pValue.use_count() == 1);
+	}
+
+	SECTION("Shared Pointer Expiry")
+	{
+		struct Listener
+		{
+			void Call(int v) { Value += v; }
+			int Value = 0;
+		};
+		std::shared_ptr<Listener> pListener = std::make_shared<Listener>();
+		CompactMulticastDelegate<int> del;
+		del.AddSP(pListener, &Listener::Call);
+		del.Broadcast(3);
+		REQUIRE(pListener->Value == 3);
+		pListener.reset();
+		del.Broadcast(3);
+		REQUIRE(del.GetListeners() == nullptr);
+	}
+}
+
+TEST_CASE("Shared Delegate", "Share")
+{
+	SECTION("Copies Share The Closure")
+	{
+		std::shared_ptr<int> pValue = std::make_shared<int>(2);
+		std::array<int, 32> big{};
+		big[0] = 1;
+		Delegate<int, int> del = Delegate<int, int>::CreateLambda([pValue, big](int a) { return a * *pValue + big[0]; });
+		REQUIRE(del.IsShared() == false);
+		del.Share();
+		REQUIRE(del.IsShared());
+		REQUIRE(pValue.use_count() == 2);
+		REQUIRE(del.Execute(3) == 7);
+
+		//Copies are stored inline and don't allocate
+		std::vector<Delegate<int, int>> copies;
+		copies.reserve(16);
+		Delegates::SetAllocationCallbacks(&CountingAlloc, &CountingFree);
+		g_Allocations = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			copies.push_back(del);
+		}
+		REQUIRE(g_Allocations == 0);
+		Delegates::SetAllocationCallbacks([](size_t size) { return malloc(size); }, [](void* pPtr) { free(pPtr); });
+		REQUIRE(pValue.use_count() == 2);
+		for (const Delegate<int, int>& copy : copies)
+		{
+			REQUIRE(copy.IsShared());
+			REQUIRE(copy.GetSize() <= DELEGATE_INLINE_ALLOCATION_SIZE);
+			REQUIRE(copy.Execute(1) == 3);
+		}
+
+		Delegate<int, int> moved = std::move(copies[0]);
+		REQUIRE(moved.Execute(2) == 5);
+
+		copies.clear();
+		moved.Clear();
+		REQUIRE(pValue.use_count() == 2);
+		del.Clear();
+		REQUIRE(pValue.use_count() == 1);
+	}
+
+	SECTION("Make Unique")
+	{
+		std::shared_ptr<int> pValue = std::make_shared<int>(1);
+		Delegate<int> del = Delegate<int>::CreateLambda([pValue]() { return *pValue; });
+		del.Share();
+		Delegate<int> copy = del;
+		copy.MakeUnique();
+		REQUIRE(copy.IsShared());
+		REQUIRE(pValue.use_count() == 3);
+		REQUIRE(copy.Execute() == 1);
+		REQUIRE(del.Execute() == 1);
+	}
+
+	SECTION("Copy On Write")
+	{
+		//Every copy keeps its own state, like copies that aren't shared
+		int count = 0;
+		Delegate<int> del = Delegate<int>::CreateLambda([count]() mutable { return ++count; });
+		del.Share();
+		Delegate<int> copy = del;
+		Delegate<int> other = del;
+		REQUIRE(del.Execute() == 1);
+		REQUIRE(del.Execute() == 2);
+		REQUIRE(copy.Execute() == 1);
+		REQUIRE(other.Execute() == 1);
+		REQUIRE(copy.Execute() == 2);
+		REQUIRE(del.Execute() == 3);
+
+		//A payload taken by non-const reference can change as well
+		Delegate<int> counter = Delegate<int>::CreateLambda([](int& calls) { return ++calls; }, 0);
+		counter.Share();
+		Delegate<int> counterCopy = counter;
+		REQUIRE(counter.Execute() == 1);
+		REQUIRE(counterCopy.Execute() == 1);
+
+		//Multicast and async copies execute their own copy
+		MulticastDelegateRet<int> multicast;
+		multicast.Add(Delegate<int>(del));
+		multicast.Add(Delegate<int>(del));
+		REQUIRE(multicast.Broadcast<Delegates::Sum<int>>() == 8);
+		REQUIRE(multicast.Broadcast<Delegates::Sum<int>>() == 10);
+		REQUIRE(del.Execute() == 4);
+	}
+
+	SECTION("Multicast")
+	{
+		struct Listener
+		{
+			void Call(int v) { Value += v; }
+			int Value = 0;
+		};
+		std::shared_ptr<Listener> pListener = std::make_shared<Listener>();
+		MulticastDelegate<int>::DelegateT del = MulticastDelegate<int>::DelegateT::CreateSP(pListener, &Listener::Call);
+		del.Share();
+		REQUIRE(del.GetOwner() == pListener.get());
+
+		MulticastDelegate<int> multicast;
+		multicast.Add(MulticastDelegate<int>::DelegateT(del));
+		multicast.Add(MulticastDelegate<int>::DelegateT(del));
+		multicast.Broadcast(2);
+		REQUIRE(pListener->Value == 4);
+		multicast.RemoveObject(pListener.get());
+		REQUIRE(multicast.GetSize() == 0);
+
+		multicast.Add(MulticastDelegate<int>::DelegateT(del));
+		pListener.reset();
+		multicast.Broadcast(2);
+		REQUIRE(multicast.GetSize() == 0);
+	}
+}
+
+namespace ParameterTest
+{
+	struct CopyCounter
+	{
+		CopyCounter() = default;
+		CopyCounter(const CopyCounter& other) : Data(other.Data) { ++Copies; }
+		CopyCounter(CopyCounter&& other) noexcept : Data(other.Data) { ++Moves; }
+		CopyCounter& operator=(const CopyCounter&) = default;
+
+		static void Reset()
+		{
+			Copies = 0;
+			Moves = 0;
+		}
+
+		static int Copies;
+		static int Moves;
+		std::array<int, 16> Data{};
+	};
+	int CopyCounter::Copies = 0;
+	int CopyCounter::Moves = 0;
+
+	void TakeCopy(CopyCounter) {}
+
+	static_assert(std::is_same<_DelegatesInteral::ParameterType<int>, int>::value, "Scalars are passed by value");
+	struct Vector2
+	{
+		float X, Y;
+	};
+
+	static_assert(std::is_same<_DelegatesInteral::ParameterType<Vector2>, Vector2>::value, "Small trivially copyable types are passed by value");
+	static_assert(std::is_same<_DelegatesInteral::ParameterType<CopyCounter>, const CopyCounter&>::value, "Other types are passed by reference");
+	static_assert(std::is_same<_DelegatesInteral::ParameterType<CopyCounter&>, CopyCounter&>::value, "References are kept");
+}
+
+TEST_CASE("Argument Copies", "ParameterType")
+{
+	using namespace ParameterTest;
+	CopyCounter counter;
+
+	SECTION("Broadcast")
+	{
+		MulticastDelegate<CopyCounter> multicast;
+		for (int i = 0; i < 4; ++i)
+		{
+			multicast.AddLambda([](CopyCounter) {});
+		}
+		CopyCounter::Reset();
+		multicast.Broadcast(counter);
+		//One copy for every delegate, none for Broadcast itself
+		REQUIRE(CopyCounter::Copies == 4);
+
+		CopyCounter::Reset();
+		multicast.Broadcast(CopyCounter());
+		REQUIRE(CopyCounter::Copies == 4);
+	}
+
+	SECTION("Static Broadcast")
+	{
+		using Multicast = StaticMulticastDelegate<void(*)(CopyCounter), &TakeCopy, &TakeCopy, &TakeCopy, &TakeCopy>;
+		CopyCounter::Reset();
+		Multicast::Broadcast(counter);
+		REQUIRE(CopyCounter::Copies == 4);
+
+		CopyCounter::Reset();
+		Multicast()(counter);
+		REQUIRE(CopyCounter::Copies == 4);
+	}
+
+	SECTION("Broadcast By Reference")
+	{
+		MulticastDelegate<const CopyCounter&> multicast;
+		for (int i = 0; i < 4; ++i)
+		{
+			multicast.AddLambda([&counter](const CopyCounter& value) { REQUIRE(&value == &counter); });
+		}
+		CopyCounter::Reset();
+		multicast.Broadcast(counter);
+		REQUIRE(CopyCounter::Copies == 0);
+	}
+
+	SECTION("Broadcast Return Value")
+	{
+		MulticastDelegateRet<int, CopyCounter> multicast;
+		for (int i = 0; i < 4; ++i)
+		{
+			multicast.AddLambda([](CopyCounter value) { return value.Data[0]; });
+		}
+		CopyCounter::Reset();
+		multicast.Broadcast<Delegates::Sum<int>>(counter);
+		REQUIRE(CopyCounter::Copies == 4);
+	}
+
+	SECTION("Execute")
+	{
+		Delegate<void, CopyCounter> del = Delegate<void, CopyCounter>::CreateLambda([](CopyCounter) {});
+		CopyCounter::Reset();
+		del.Execute(counter);
+		REQUIRE(CopyCounter::Copies == 1);
+
+		//Rvalues are moved all the way to the bound function
+		CopyCounter::Reset();
+		del.Execute(CopyCounter());
+		REQUIRE(CopyCounter::Copies == 0);
+	}
+}
+
 int main(int argc, char* argv[])
 {
 	// Enable run-time memory leak check for debug builds.
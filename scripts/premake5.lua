@@ -9,6 +9,7 @@ workspace "Delegates"
 	defines { "_CONSOLE" }
 	flags {"FatalWarnings"}
 	language "C++"
+	cppdialect "C++17"
 
     filter { "platforms:x64" }
 		architecture "x64"
@@ -49,6 +50,27 @@ workspace "Delegates"
 			"../**.natvis",
 		}
 
+		removefiles
+		{
+			"../Benchmarks/**",
+		}
+
+	project "Benchmarks"
+		filename "Benchmarks"
+		location ".."
+		targetdir "../Build/$(ProjectName)_$(Platform)_$(Configuration)"
+		objdir "!../Build/Intermediate/$(ProjectName)_$(Platform)_$(Configuration)"
+
+		kind "ConsoleApp"
+
+		files
+		{ 
+			"../Delegates.h",
+			"../Delegates.cpp",
+			"../Delegates.natvis",
+			"../Benchmarks/**.cpp",
+		}
+
 newaction {
 		trigger     = "clean",
 		description = "Remove all binaries and generated files",